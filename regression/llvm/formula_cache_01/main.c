@@ -0,0 +1,15 @@
+#include <assert.h>
+
+int nondet_int();
+
+int x;
+
+int main()
+{
+  // Only one counterexample, so a trace rebuilt from the cache has to show
+  // the same value the solver found
+  x = nondet_int();
+  __ESBMC_assume(x > 41 && x < 43);
+  assert(x != 42);
+  return 0;
+}
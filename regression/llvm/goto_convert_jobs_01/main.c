@@ -0,0 +1,27 @@
+int nondet_int();
+
+int inc(int x) { return x + 1; }
+
+int twice(int x) { return inc(x) + inc(x) - 2; }
+
+int pick(int c, int a, int b) { return c ? inc(a) : inc(b); }
+
+int clamp(int x)
+{
+  if (x < 0)
+    return 0;
+  return x > 10 ? 10 : x;
+}
+
+int main()
+{
+  int a = nondet_int();
+  __ESBMC_assume(a >= 0 && a < 5);
+
+  int b = twice(a);
+  int c = pick(a > 2, b, a);
+
+  __ESBMC_assert(clamp(b) == 2 * a, "twice stays in range");
+  __ESBMC_assert(c != 7, "pick can reach 7");
+  return 0;
+}
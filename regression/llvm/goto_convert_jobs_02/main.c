@@ -0,0 +1,40 @@
+#include <assert.h>
+
+unsigned int nondet_uint();
+
+int last(unsigned int n)
+{
+  int a[n];
+  unsigned int i;
+
+  for(i = 0; i < n; i++)
+    a[i] = i;
+
+  return a[n - 1];
+}
+
+int sum(unsigned int n)
+{
+  int b[n];
+  int s = 0;
+  unsigned int i;
+
+  for(i = 0; i < n; i++)
+    b[i] = 2;
+  for(i = 0; i < n; i++)
+    s += b[i];
+
+  return s;
+}
+
+int main()
+{
+  unsigned int n = nondet_uint();
+  __ESBMC_assume(n > 0 && n < 4);
+
+  assert(last(n) == n - 1);
+  assert(sum(n) == 2 * n);
+  assert(sum(n) != 6);
+
+  return 0;
+}
@@ -0,0 +1,16 @@
+#include <assert.h>
+
+int main()
+{
+  unsigned int i = 0;
+
+  // Only fails on the fourth iteration, so the base case has to get through
+  // a few k steps, reusing the solver context, before finding it.
+  while(i < 10)
+  {
+    assert(i != 3);
+    i++;
+  }
+
+  return 0;
+}
@@ -0,0 +1,12 @@
+int a[10];
+
+int main()
+{
+  int i;
+
+  // Every lower bound check holds, but the last upper bound check does not
+  for(i = 0; i <= 10; i++)
+    a[i] = i;
+
+  return 0;
+}
@@ -0,0 +1,14 @@
+int nondet_int();
+
+int main()
+{
+  int n = nondet_int();
+  int i = 0;
+
+  // The inductive step assumes i < n on entry to the loop, which would make
+  // n non-zero; the base case still has to check the division for n == 0.
+  while(i < n)
+    i++;
+
+  return 100 / n;
+}
@@ -0,0 +1,12 @@
+int nondet_int();
+
+int g;
+
+int main()
+{
+  int x = nondet_int();
+  if(x > 0)
+    g = 1;
+  assert(g <= 1);
+  return 0;
+}
@@ -0,0 +1,16 @@
+#include <assert.h>
+
+int nondet_int();
+
+int main()
+{
+  int a[4];
+  int x = nondet_int();
+  __ESBMC_assume(x >= 0 && x < 4);
+
+  a[x] = x;
+  assert(a[x] >= 0);
+  assert(a[x] != 3);
+
+  return 0;
+}
@@ -0,0 +1,17 @@
+#include <assert.h>
+
+int nondet_int();
+
+int main()
+{
+  int x = nondet_int();
+  int y = x;
+  __ESBMC_assume(x > 0 && x < 100);
+
+  assert(y > 0);
+  assert(y < 100);
+  assert(x + y != 10);
+  assert(x != 100);
+
+  return 0;
+}
@@ -0,0 +1,22 @@
+#include <assert.h>
+#include <pthread.h>
+
+int x;
+
+void *t1(void *arg)
+{
+  x = 1;
+  return NULL;
+}
+
+int main()
+{
+  pthread_t id;
+  pthread_create(&id, NULL, t1, NULL);
+
+  assert(x == 0 || x == 1);
+  assert(x == 0);
+
+  pthread_join(id, NULL);
+  return 0;
+}
@@ -0,0 +1,34 @@
+#include <assert.h>
+#include <pthread.h>
+
+int g;
+
+void *t1(void *arg)
+{
+  g = 1;
+  return NULL;
+}
+
+void *t2(void *arg)
+{
+  g = 2;
+  return NULL;
+}
+
+void *t3(void *arg)
+{
+  // Fails only when t2 ran last before us: 2 of the 6 orders
+  assert(g != 2);
+  return NULL;
+}
+
+int main()
+{
+  pthread_t id1, id2, id3;
+
+  pthread_create(&id1, NULL, t1, NULL);
+  pthread_create(&id2, NULL, t2, NULL);
+  pthread_create(&id3, NULL, t3, NULL);
+
+  return 0;
+}
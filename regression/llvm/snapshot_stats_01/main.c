@@ -0,0 +1,34 @@
+#include <assert.h>
+#include <pthread.h>
+
+int done[4];
+
+void *worker(void *arg)
+{
+  int id = (int)(long)arg;
+  int i, n = 0;
+
+  // Each thread's own locals have to survive every switch away from it
+  for(i = 0; i < 3; i++)
+  {
+    n++;
+    done[id] = n;
+  }
+
+  return NULL;
+}
+
+int main()
+{
+  pthread_t id[4];
+  long i;
+
+  for(i = 0; i < 4; i++)
+    pthread_create(&id[i], NULL, worker, (void *)i);
+
+  for(i = 0; i < 4; i++)
+    pthread_join(id[i], NULL);
+
+  assert(done[0] == 3 && done[1] == 3 && done[2] == 3 && done[3] == 3);
+  return 0;
+}
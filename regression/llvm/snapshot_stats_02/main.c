@@ -0,0 +1,26 @@
+#include <assert.h>
+#include <pthread.h>
+
+int g;
+
+void *inc(void *arg)
+{
+  // Lost update: the first thread has to resume with the value it read
+  // before the second thread ran to completion
+  int tmp = g;
+  g = tmp + 1;
+  return NULL;
+}
+
+int main()
+{
+  pthread_t t1, t2;
+
+  pthread_create(&t1, NULL, inc, NULL);
+  pthread_create(&t2, NULL, inc, NULL);
+  pthread_join(t1, NULL);
+  pthread_join(t2, NULL);
+
+  assert(g == 2);
+  return 0;
+}
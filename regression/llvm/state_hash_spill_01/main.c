@@ -0,0 +1,28 @@
+#include <assert.h>
+#include <pthread.h>
+
+int a, b;
+
+void *t1(void *arg)
+{
+  a = 1;
+  return NULL;
+}
+
+void *t2(void *arg)
+{
+  b = 1;
+  // Fails only when t1 ran first
+  assert(a == 0);
+  return NULL;
+}
+
+int main()
+{
+  pthread_t id1, id2;
+
+  pthread_create(&id1, NULL, t1, NULL);
+  pthread_create(&id2, NULL, t2, NULL);
+
+  return 0;
+}
@@ -268,13 +268,32 @@ digit_div (onedig_t *r, const onedig_t *y, unsigned yl, onedig_t *q, unsigned ql
   }
 }
 
-// Newly allocate uninitialized space for specified number of digits.
+// Newly allocate uninitialized space for specified number of digits,
+// within this if it fits. Doesn't release any previous digit vector.
 inline void
 BigInt::allocate (unsigned digits)
 {
-  size = adjust_size (digits);
-  length = 0;
-  digit = new onedig_t[size];
+  if(digits <= inline_size)
+  {
+    size = inline_size;
+    digit = inline_digit;
+  }
+  else
+  {
+    size = adjust_size(digits);
+    digit = new onedig_t[size];
+  }
+}
+
+// Give back the digit vector, if it was allocated by this.
+inline void
+BigInt::release()
+{
+  if(size != 0u && digit != inline_digit)
+  {
+    memset(digit, 0, size * sizeof digit[0]); // Crypto-paranoia.
+    delete[] digit;
+  }
 }
 
 // Used in assignment: When smaller than specified digits, allocate
@@ -284,10 +303,8 @@ BigInt::reallocate (unsigned digits)
 {
   if(digits > size)
   {
-    if(size != 0u)
-      delete[] digit;
-    size = adjust_size(digits);
-    digit = new onedig_t[size];
+    release();
+    allocate(digits);
   }
 }
 
@@ -298,15 +315,18 @@ BigInt::resize (unsigned digits)
   if(digits > size)
   {
     onedig_t *old_digit = digit;
+    bool old_heap = size != 0u && digit != inline_digit;
     unsigned old_size = size;
-    size = adjust_size(digits);
-    digit = new onedig_t[size];
+    allocate(digits);
 
-    if(old_digit != nullptr)
+    if(old_digit != nullptr && old_digit != digit)
     {
       memcpy(digit, old_digit, length * sizeof(onedig_t));
-      if(old_size != 0u)
+      if(old_heap)
+      {
+        memset(old_digit, 0, old_size * sizeof(onedig_t));
         delete[] old_digit;
+      }
     }
   }
 }
@@ -347,6 +367,19 @@ digit_set (ullong_t ul, onedig_t d[small], unsigned &l)
   }
 }
 
+// Read back a string of at most small onedig_t.
+inline ullong_t
+digit_get (onedig_t const *d, unsigned l)
+{
+  ullong_t ul = 0;
+  while(l != 0u)
+  {
+    ul <<= single_bits;
+    ul |= d[--l];
+  }
+  return ul;
+}
+
 void
 BigInt::assign (ullong_t ul)
 {
@@ -372,11 +405,7 @@ BigInt::assign (llong_t l)
 
 BigInt::~BigInt()
 {
-  if (size > 0)
-    {
-      memset (digit, 0, size * sizeof digit[0]); // Crypto-paranoia.
-      delete[] digit;
-    }
+  release();
 }
 
 BigInt::BigInt (onedig_t *dig, unsigned len, bool pos)
@@ -387,73 +416,72 @@ BigInt::BigInt (onedig_t *dig, unsigned len, bool pos)
 {}
 
 BigInt::BigInt()
-  : size (adjust_size (small)),
+  : size (inline_size),
     length (0),
-    digit (new onedig_t[size]),
+    digit (inline_digit),
     positive (true)
 {}
 
 BigInt::BigInt (signed long int n)
-  : size (adjust_size (small)),
+  : size (inline_size),
     length (0),
-    digit (new onedig_t[size])
+    digit (inline_digit)
 {
   assign (llong_t (n));
 }
 
 BigInt::BigInt (unsigned long int n)
-  : size (adjust_size (small)),
+  : size (inline_size),
     length (0),
-    digit (new onedig_t[size])
+    digit (inline_digit)
 {
   assign (ullong_t (n));
 }
 
 BigInt::BigInt (int n)
-  : size (adjust_size (small)),
+  : size (inline_size),
     length (0),
-    digit (new onedig_t[size])
+    digit (inline_digit)
 {
   assign (llong_t (n));
 }
 
 BigInt::BigInt (unsigned u)
-  : size (adjust_size (small)),
+  : size (inline_size),
     length (0),
-    digit (new onedig_t[size])
+    digit (inline_digit)
 {
   assign (ullong_t (u));
 }
 
 BigInt::BigInt (llong_t l)
-  : size (adjust_size (small)),
+  : size (inline_size),
     length (0),
-    digit (new onedig_t[size])
+    digit (inline_digit)
 {
   assign (l);
 }
 
 BigInt::BigInt (ullong_t ul)
-  : size (adjust_size (small)),
+  : size (inline_size),
     length (0),
-    digit (new onedig_t[size])
+    digit (inline_digit)
 {
   assign (ul);
 }
 
 BigInt::BigInt (BigInt const &y)
-  : size (adjust_size (y.length)),
-    length (y.length),
-    digit (new onedig_t[size]),
+  : length (y.length),
     positive (y.positive)
 {
+  allocate (length);
   memcpy (digit, y.digit, length * sizeof (onedig_t));
 }
 
 BigInt::BigInt (char const *s, onedig_t b)
-  : size (adjust_size (small)),
+  : size (inline_size),
     length (0),
-    digit (new onedig_t[size]),
+    digit (inline_digit),
     positive (true)
 {
   scan (s, b);
@@ -759,17 +787,11 @@ BigInt::compare (ullong_t b) const
   if(!positive)
     return -1;
 
-  onedig_t dig[small];
-  unsigned len;
-  digit_set(b, dig, len);
-
-  if(length < len)
-    return -1;
-
-  if(length > len)
+  if(length > small)
     return 1;
 
-  return digit_cmp(digit, dig, len);
+  ullong_t a = digit_get(digit, length);
+  return a < b ? -1 : a > b ? 1 : 0;
 }
 
 int
@@ -793,6 +815,35 @@ BigInt::compare (BigInt const &b) const
 void
 BigInt::add (onedig_t const *dig, unsigned len, bool pos)
 {
+  if(length <= small && len <= small)
+  {
+    // Both magnitudes fit an elementary integer: work on those, unless
+    // a sum carries out of it.
+    ullong_t a = digit_get(digit, length);
+    ullong_t b = digit_get(dig, len);
+    if(positive == pos)
+    {
+      if(a + b >= a)
+      {
+        digit_set(a + b, digit, length);
+        return;
+      }
+    }
+    else
+    {
+      if(a >= b)
+        digit_set(a - b, digit, length);
+      else
+      {
+        digit_set(b - a, digit, length);
+        positive = pos;
+      }
+      if(length == 0)
+        positive = true;
+      return;
+    }
+  }
+
   // Make sure the result fits into this, even with carry.
   resize((length > len ? length : len) + 1);
 
@@ -843,7 +894,18 @@ BigInt::add (onedig_t const *dig, unsigned len, bool pos)
 void
 BigInt::mul (onedig_t const *dig, unsigned len, bool pos)
 {
-  if(len < 2)
+  if(length + len <= small)
+  {
+    // Both operands are short enough for the product to fit an
+    // elementary integer, so just multiply those.
+    digit_set(digit_get(digit, length) * digit_get(dig, len), digit, length);
+    if(length == 0)
+    {
+      positive = true;
+      return;
+    }
+  }
+  else if(len < 2)
   {
     // Handle small dig/len operand efficiently.
     if(len == 0 || dig[0] == 0)
@@ -884,10 +946,12 @@ BigInt::mul (onedig_t const *dig, unsigned len, bool pos)
   }
   else
   {
-    // Get a new string of digits for the result.
-    unsigned old_size = size;
-    size = adjust_size(length + len);
-    auto r = new onedig_t[size];
+    // Get a scratch string of digits for the result. It lives on the stack
+    // unless the product is too long for that to be safe.
+    enum { scratch_size = 64 };
+    onedig_t scratch[scratch_size];
+    unsigned rl = length + len;
+    onedig_t *r = rl <= scratch_size ? scratch : new onedig_t[rl];
 
     // The first parameter pair defines the outer loop which should
     // be the shorter.
@@ -896,12 +960,15 @@ BigInt::mul (onedig_t const *dig, unsigned len, bool pos)
     else
       digit_mul(dig, len, digit, length, r);
 
-    // Replace digit string of this with result.
-    if(old_size != 0u)
-      delete[] digit;
-    digit = r;
-    length += len;
+    // Replace digit string of this with result. A product of two 64 bit
+    // numbers still fits within this.
+    reallocate(rl);
+    memcpy(digit, r, rl * sizeof(onedig_t));
+    length = rl;
     adjust();
+
+    if(r != scratch)
+      delete[] r;
   }
   if(!pos)
     positive = !positive;
@@ -115,14 +115,20 @@ public:
   // by an elementary type.
   enum { small = sizeof (ullong_t) / sizeof (onedig_t) };
 
+  // Digit vectors up to this long are kept within the object itself, so
+  // that the common small values never touch the heap.
+  enum { inline_size = small + 2 };
+
 private:
   unsigned size;			// Length of digit vector.
   unsigned length;			// Used places in digit vector.
   onedig_t *digit;			// Least significant first.
   bool positive;			// Signed magnitude representation.
+  onedig_t inline_digit[inline_size];	// Digit vector, while it fits.
 
   // Create or resize this.
   inline void allocate (unsigned digits);
+  inline void release();
   inline void reallocate (unsigned digits);
   inline void resize (unsigned digits);
 
@@ -19,7 +19,8 @@ extern "C" {
 #include <c2goto/cprover_library.h>
 #include <cstdlib>
 #include <fstream>
-#include <goto-programs/read_goto_binary.h>
+#include <goto-programs/read_bin_goto_object.h>
+#include <set>
 #include <sstream>
 #include <util/c_link.h>
 #include <util/config.h>
@@ -48,72 +49,6 @@ uint8_t *clib_ptrs[4][4] = {
 #undef p
 #endif
 
-bool
-is_in_list(std::list<irep_idt> &list, irep_idt item)
-{
-
-  for(std::list<irep_idt>::const_iterator it = list.begin(); it != list.end();
-      it++)
-    if (*it == item)
-      return true;
-
-  return false;
-}
-
-void
-generate_symbol_deps(irep_idt name, irept irep, std::multimap<irep_idt, irep_idt> &deps)
-{
-  std::pair<irep_idt, irep_idt> type;
-
-  if (irep.id() == "symbol") {
-    type = std::pair<irep_idt, irep_idt>(name, irep.identifier());
-    deps.insert(type);
-    return;
-  }
-
-  forall_irep(irep_it, irep.get_sub()) {
-    if (irep_it->id() == "symbol") {
-      type = std::pair<irep_idt, irep_idt>(name, irep_it->identifier());
-      deps.insert(type);
-      generate_symbol_deps(name, *irep_it, deps);
-    } else if (irep_it->id() == "argument") {
-      type = std::pair<irep_idt, irep_idt>(name, irep_it->cmt_identifier());
-      deps.insert(type);
-    } else {
-      generate_symbol_deps(name, *irep_it, deps);
-    }
-  }
-
-  forall_named_irep(irep_it, irep.get_named_sub()) {
-    if (irep_it->second.id() == "symbol") {
-      type = std::pair<irep_idt, irep_idt>(name, irep_it->second.identifier());
-      deps.insert(type);
-    } else if (irep_it->second.id() == "argument") {
-      type = std::pair<irep_idt, irep_idt>(name, irep_it->second.cmt_identifier());
-      deps.insert(type);
-    } else {
-      generate_symbol_deps(name, irep_it->second, deps);
-    }
-  }
-}
-
-void
-ingest_symbol(irep_idt name, std::multimap<irep_idt, irep_idt> &deps, std::list<irep_idt> &to_include)
-{
-  std::pair<std::multimap<irep_idt,irep_idt>::const_iterator,
-            std::multimap<irep_idt,irep_idt>::const_iterator> range;
-  std::multimap<irep_idt, irep_idt>::const_iterator it;
-
-  range = deps.equal_range(name);
-  if (range.first == range.second)
-    return;
-
-  for (it = range.first; it != range.second; it++)
-    to_include.push_back(it->second);
-
-  deps.erase(name);
-}
-
 #ifdef NO_CPROVER_LIBRARY
 void
 add_cprover_library(
@@ -131,15 +66,9 @@ void add_cprover_library(
   if(config.ansi_c.lib==configt::ansi_ct::libt::LIB_NONE)
     return;
 
-  contextt new_ctx, store_ctx;
-  goto_functionst goto_functions;
-  std::multimap<irep_idt, irep_idt> symbol_deps;
-  std::list<irep_idt> to_include;
-  char symname_buffer[288];
-  FILE *f;
+  contextt store_ctx;
   uint8_t **this_clib_ptrs;
   uint64_t size;
-  int fd;
 
   if (config.ansi_c.word_size == 32) {
     if(config.ansi_c.use_fixed_for_float) {
@@ -170,83 +99,58 @@ void add_cprover_library(
     abort();
   }
 
-#ifndef _WIN32
-  sprintf(symname_buffer, "/tmp/ESBMC_XXXXXX");
-  fd = mkstemp(symname_buffer);
-  close(fd);
-#else
-  char tmpdir[256];
-  GetTempPath(sizeof(tmpdir), tmpdir);
-  GetTempFileName(tmpdir, "bmc", 0, symname_buffer);
-#endif
-  f = fopen(symname_buffer, "wb");
-  if (fwrite(this_clib_ptrs[0], size, 1, f) != 1) {
-    std::cerr << "Couldn't manipulate internal C library" << std::endl;
+  bin_goto_objectt library(
+    reinterpret_cast<const char *>(this_clib_ptrs[0]), size,
+    "<built-in-library>", message_handler);
+
+  if (library.read_index()) {
+    std::cerr << "Failed to read internal C library" << std::endl;
     abort();
   }
-  fclose(f);
-
-  std::ifstream infile(symname_buffer, std::ios::in | std::ios::binary);
-  read_goto_binary(infile, new_ctx, goto_functions, message_handler);
-  infile.close();
-#ifndef _WIN32
-  unlink(symname_buffer);
-#else
-  DeleteFile(symname_buffer);
-#endif
-
-  new_ctx.foreach_operand(
-    [&symbol_deps] (const symbolt& s)
-    {
-      generate_symbol_deps(s.name, s.value, symbol_deps);
-      generate_symbol_deps(s.name, s.type, symbol_deps);
-    }
-  );
 
   // Add two hacks; we migth use either pthread_mutex_lock or the checked
   // variety; so if one version is used, pull in the other too.
-  std::pair<irep_idt,irep_idt>
-    lockcheck(dstring("pthread_mutex_lock"),
-              dstring("pthread_mutex_lock_check"));
-  symbol_deps.insert(lockcheck);
-
-  std::pair<irep_idt,irep_idt>
-    condcheck(dstring("pthread_cond_wait"),
-              dstring("pthread_cond_wait_check"));
-  symbol_deps.insert(condcheck);
-
-  std::pair<irep_idt,irep_idt>
-    joincheck(dstring("pthread_join"),
-              dstring("pthread_join_noswitch"));
-  symbol_deps.insert(joincheck);
-
-  /* The code just pulled into store_ctx might use other symbols in the C
-   * library. So, repeatedly search for new C library symbols that we use but
-   * haven't pulled in, then pull them in. We finish when we've made a pass
-   * that adds no new symbols. */
-
-  new_ctx.foreach_operand(
-    [&context, &store_ctx, &symbol_deps, &to_include] (const symbolt& s)
-    {
-      const symbolt* symbol = context.find_symbol(s.name);
-      if (symbol != nullptr && symbol->value.is_nil())
-      {
-        store_ctx.add(s);
-        ingest_symbol(s.name, symbol_deps, to_include);
-      }
-    }
-  );
+  std::multimap<irep_idt, irep_idt> extra_deps;
+  extra_deps.insert(std::make_pair(dstring("pthread_mutex_lock"),
+                                   dstring("pthread_mutex_lock_check")));
+  extra_deps.insert(std::make_pair(dstring("pthread_cond_wait"),
+                                   dstring("pthread_cond_wait_check")));
+  extra_deps.insert(std::make_pair(dstring("pthread_join"),
+                                   dstring("pthread_join_noswitch")));
+
+  /* Pull in the library's definition of everything the program declares but
+   * doesn't define. That code might use other symbols in the C library, so
+   * follow the dependencies recorded in the library's index until nothing
+   * new turns up. Only the symbols pulled in ever get decoded. */
+  std::list<irep_idt> to_include;
+  for (const auto &name : library.symbol_names())
+  {
+    const symbolt* symbol = context.find_symbol(name);
+    if (symbol != nullptr && symbol->value.is_nil())
+      to_include.push_back(name);
+  }
 
+  std::set<irep_idt> included;
   for (std::list<irep_idt>::const_iterator nameit = to_include.begin();
       nameit != to_include.end();
       nameit++)
   {
-    symbolt* s = new_ctx.find_symbol(*nameit);
-    if (s != nullptr)
-    {
-      store_ctx.add(*s);
-      ingest_symbol(*nameit, symbol_deps, to_include);
+    if (!library.has_symbol(*nameit) || !included.insert(*nameit).second)
+      continue;
+
+    symbolt s;
+    if (library.read_symbol(*nameit, s)) {
+      std::cerr << "Failed to read internal C library" << std::endl;
+      abort();
     }
+    store_ctx.add(s);
+
+    const bin_goto_objectt::namest &deps = library.symbol_deps(*nameit);
+    to_include.insert(to_include.end(), deps.begin(), deps.end());
+
+    auto range = extra_deps.equal_range(*nameit);
+    for (auto it = range.first; it != range.second; it++)
+      to_include.push_back(it->second);
   }
 
   if (c_link(context, store_ctx, message_handler, "<built-in-library>")) {
@@ -7,10 +7,15 @@ Authors: Daniel Kroening, kroening@kroening.com
 
 \*******************************************************************/
 
+#include <cerrno>
 #include <csignal>
 #include <sys/types.h>
 
 #ifndef _WIN32
+#include <poll.h>
+#include <semaphore.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
 #include <unistd.h>
 #else
 #include <windows.h>
@@ -24,6 +29,7 @@ Authors: Daniel Kroening, kroening@kroening.com
 #include <esbmc/document_subgoals.h>
 #include <fstream>
 #include <goto-symex/build_goto_trace.h>
+#include <goto-symex/formula_cache.h>
 #include <goto-symex/goto_trace.h>
 #include <goto-symex/reachability_tree.h>
 #include <goto-symex/slice.h>
@@ -39,6 +45,7 @@ Authors: Daniel Kroening, kroening@kroening.com
 #include <util/migrate.h>
 #include <util/show_symbol_table.h>
 #include <util/time_stopping.h>
+#include <vector>
 
 bmct::bmct(const goto_functionst &funcs,
   optionst &opts,
@@ -48,7 +55,11 @@ bmct::bmct(const goto_functionst &funcs,
     options(opts),
     context(_context),
     ns(context),
-    ui(ui_message_handlert::PLAIN)
+    ui(ui_message_handlert::PLAIN),
+    inc_committed(0),
+    inc_assumpt_ast(nullptr),
+    inc_ctx_pushed(false),
+    claims_need_fresh_solver(false)
 {
   interleaving_number = 0;
   interleaving_failed = 0;
@@ -163,7 +174,10 @@ void bmct::error_trace(
 
   goto_tracet goto_trace;
   int specification = 0;
-  build_goto_trace(eq, smt_conv, goto_trace);
+  if(cached_trace)
+    goto_trace = *cached_trace;
+  else
+    build_goto_trace(eq, smt_conv, goto_trace);
 
   std::string witness_output = options.get_option("witness-output");
   if(!witness_output.empty())
@@ -262,6 +276,165 @@ bmct::run_decision_procedure(
   return dec_result;
 }
 
+smt_convt::resultt
+bmct::run_cached_decision_procedure(
+  boost::shared_ptr<symex_target_equationt> &eq)
+{
+  formula_cachet cache(options.get_option("formula-cache"), options);
+  cache.compute_key(*eq);
+
+  smt_convt::resultt res;
+  goto_tracet goto_trace;
+  if(cache.lookup(*eq, res, goto_trace))
+  {
+    status("Formula cache hit " + cache.key().to_string());
+    runtime_solver.reset();
+    if(res == smt_convt::P_SATISFIABLE)
+      cached_trace = std::make_shared<goto_tracet>(goto_trace);
+    return res;
+  }
+
+  runtime_solver =
+    boost::shared_ptr<smt_convt>(
+      create_solver_factory(
+        "",
+        options.get_bool_option("int-encoding"),
+        ns,
+        options));
+
+  res = run_decision_procedure(runtime_solver, eq);
+  cache.store(*eq, res, *runtime_solver);
+  return res;
+}
+
+static bool same_SSA_step(
+  const symex_target_equationt::SSA_stept &a,
+  const symex_target_equationt::SSA_stept &b)
+{
+  return a.type == b.type && a.ignore == b.ignore
+         && a.source.pc == b.source.pc && a.source.thread_nr == b.source.thread_nr
+         && a.guard == b.guard && a.lhs == b.lhs && a.rhs == b.rhs
+         && a.cond == b.cond && a.output_args == b.output_args;
+}
+
+smt_convt::resultt
+bmct::run_incremental_decision_procedure(
+  boost::shared_ptr<symex_target_equationt> &eq)
+{
+  // Retract the part of the last unrolling that wasn't shared
+  if(inc_ctx_pushed)
+  {
+    inc_solver->pop_ctx();
+    inc_ctx_pushed = false;
+  }
+
+  // How much of the last unrolling does this one start with? Each k step
+  // reproduces the SSA of the previous one up to the point where the old
+  // unwinding bound was hit, with identical SSA names.
+  unsigned int common = 0;
+  if(inc_eq)
+  {
+    auto old_it = inc_eq->SSA_steps.begin();
+    auto new_it = eq->SSA_steps.begin();
+    while(old_it != inc_eq->SSA_steps.end() && new_it != eq->SSA_steps.end()
+          && same_SSA_step(*old_it, *new_it))
+    {
+      ++common;
+      ++old_it;
+      ++new_it;
+    }
+  }
+
+  // Everything in the base context has to be a prefix of this unrolling too,
+  // otherwise start again from a fresh solver.
+  if(!inc_solver || common < inc_committed)
+  {
+    inc_solver = boost::shared_ptr<smt_convt>(
+      create_solver_factory(
+        "",
+        options.get_bool_option("int-encoding"),
+        ns,
+        options));
+
+    if(!inc_solver->supports_ctx())
+    {
+      error("--incremental-base-case needs a solver with context support "
+            "(z3, yices, mathsat or smtlib)");
+      return smt_convt::P_ERROR;
+    }
+
+    inc_solver->set_message_handler(message_handler);
+    inc_solver->set_verbosity(get_verbosity());
+
+    inc_committed = 0;
+    inc_assertions.clear();
+    inc_assumpt_ast = inc_solver->convert_ast(gen_true_expr());
+  }
+
+  std::cout << "Encoding remaining VCC(s) incrementally, reusing "
+            << inc_committed << " of " << eq->SSA_steps.size()
+            << " SSA steps\n";
+
+  fine_timet encode_start = current_time();
+
+  // The committed steps were converted on behalf of an earlier equation; hand
+  // their ASTs over so that traces can be built from this one.
+  auto old_it = inc_eq ? inc_eq->SSA_steps.begin() : eq->SSA_steps.end();
+  auto it = eq->SSA_steps.begin();
+  for(unsigned int i = 0; i < inc_committed; ++i, ++it, ++old_it)
+  {
+    it->guard_ast = old_it->guard_ast;
+    it->cond_ast = old_it->cond_ast;
+    it->converted_output_args = old_it->converted_output_args;
+  }
+
+  // Steps shared with the last unrolling are likely shared with the next one
+  // as well: convert them into the base context for good.
+  for(; inc_committed < common; ++inc_committed, ++it)
+    eq->convert_internal_step(
+      *inc_solver, inc_assumpt_ast, inc_assertions, *it);
+
+  // The remainder only holds for this k; convert it in a scratch context
+  inc_solver->push_ctx();
+  inc_ctx_pushed = true;
+
+  const smt_ast *assumpt_ast = inc_assumpt_ast;
+  smt_convt::ast_vec assertions = inc_assertions;
+  for(; it != eq->SSA_steps.end(); ++it)
+    eq->convert_internal_step(*inc_solver, assumpt_ast, assertions, *it);
+
+  if(!assertions.empty())
+    inc_solver->assert_ast(inc_solver->make_disjunct(assertions));
+
+  fine_timet encode_stop = current_time();
+
+  std::ostringstream str;
+  str << "Encoding to solver time: ";
+  output_time(encode_stop - encode_start, str);
+  str << "s";
+  status(str.str());
+
+  std::stringstream ss;
+  ss << "Solving with solver " << inc_solver->solver_text();
+  status(ss.str());
+
+  fine_timet sat_start = current_time();
+  smt_convt::resultt dec_result = inc_solver->dec_solve();
+  fine_timet sat_stop = current_time();
+
+  str.str("");
+  str << "\nRuntime decision procedure: ";
+  output_time(sat_stop - sat_start, str);
+  str << "s";
+  status(str.str());
+
+  // Keep the model around for the counterexample; the scratch context is
+  // only popped when the next k step comes along.
+  inc_eq = eq;
+  runtime_solver = inc_solver;
+  return dec_result;
+}
+
 void bmct::report_success()
 {
   status("\nVERIFICATION SUCCESSFUL");
@@ -398,6 +571,10 @@ void bmct::report_trace(
   smt_convt::resultt &res,
   boost::shared_ptr<symex_target_equationt> &eq)
 {
+  // In multi-property mode each claim's trace was printed when it was solved
+  if(options.get_bool_option("multi-property"))
+    return;
+
   bool bs = options.get_bool_option("base-case");
   bool fc = options.get_bool_option("forward-condition");
   bool is = options.get_bool_option("inductive-step");
@@ -470,6 +647,11 @@ void bmct::report_result(smt_convt::resultt &res)
 
 smt_convt::resultt bmct::start_bmc()
 {
+  // The same bmct may be run several times, e.g. once per k step by an
+  // incremental base case.
+  interleaving_number = 0;
+  interleaving_failed = 0;
+
   boost::shared_ptr<symex_target_equationt> eq;
   smt_convt::resultt res = run(eq);
   report_result(res);
@@ -484,6 +666,11 @@ smt_convt::resultt bmct::run(boost::shared_ptr<symex_target_equationt> &eq)
   if(options.get_bool_option("schedule"))
     return run_thread(eq);
 
+#ifndef _WIN32
+  if(options.get_bool_option("parallel-interleavings"))
+    return run_parallel_interleavings(eq);
+#endif
+
   smt_convt::resultt res;
 
   do
@@ -520,6 +707,12 @@ smt_convt::resultt bmct::run(boost::shared_ptr<symex_target_equationt> &eq)
 
   } while(symex->setup_next_formula());
 
+  if(options.get_bool_option("memstats") && symex->hit_hashes)
+    symex->hit_hashes->output_stats(std::cout);
+
+  if(options.get_bool_option("memstats"))
+    execution_statet::output_snapshot_stats(std::cout);
+
   if (options.get_bool_option("ltl"))
   {
     // So, what was the lowest value ltl outcome that we saw?
@@ -545,6 +738,7 @@ smt_convt::resultt bmct::run(boost::shared_ptr<symex_target_equationt> &eq)
 smt_convt::resultt bmct::run_thread(boost::shared_ptr<symex_target_equationt> &eq)
 {
   boost::shared_ptr<goto_symext::symex_resultt> result;
+  cached_trace.reset();
 
   fine_timet symex_start = current_time();
   try
@@ -658,6 +852,9 @@ smt_convt::resultt bmct::run_thread(boost::shared_ptr<symex_target_equationt> &e
       return smt_convt::P_UNSATISFIABLE;
     }
 
+    if(options.get_bool_option("multi-property"))
+      return multi_property_check(eq);
+
     if (options.get_bool_option("ltl")) {
       int res = ltl_run_thread(eq);
       // Record that we've seen this outcome; later decide what the least
@@ -666,6 +863,16 @@ smt_convt::resultt bmct::run_thread(boost::shared_ptr<symex_target_equationt> &e
       return smt_convt::P_UNSATISFIABLE;
     }
 
+    if(options.get_bool_option("incremental-base-case")
+       && options.get_bool_option("base-case"))
+      return run_incremental_decision_procedure(eq);
+
+    if(options.get_bool_option("portfolio"))
+      return run_portfolio_decision_procedure(eq);
+
+    if(!options.get_option("formula-cache").empty())
+      return run_cached_decision_procedure(eq);
+
     if (!options.get_bool_option("smt-during-symex")) {
       runtime_solver =
         boost::shared_ptr<smt_convt>(
@@ -798,3 +1005,924 @@ bmct::ltl_run_thread(boost::shared_ptr<symex_target_equationt> &equation)
 
   return ltl_res_good;
 }
+
+unsigned int get_num_jobs(const optionst &options)
+{
+  int jobs = atoi(options.get_option("jobs").c_str());
+  if(jobs > 0)
+    return jobs;
+
+#ifndef _WIN32
+  long online = sysconf(_SC_NPROCESSORS_ONLN);
+  if(online > 0)
+    return online;
+#endif
+
+  return 1;
+}
+
+smt_convt::resultt bmct::run_claim(
+  const boost::shared_ptr<symex_target_equationt> &eq,
+  unsigned int claim)
+{
+  if(claims_solver || encode_claims(eq))
+    return run_claim_incrementally(claim);
+
+  // Take our own copy of the equation, in which every assertion other than
+  // the one being checked is discarded. The slicer then only keeps the
+  // assignments that this claim depends on.
+  boost::shared_ptr<symex_target_equationt> claim_eq =
+    boost::dynamic_pointer_cast<symex_target_equationt>(eq->clone());
+
+  unsigned int idx = 0;
+  for(auto &SSA_step : claim_eq->SSA_steps)
+  {
+    SSA_step.ignore = false;
+    if(SSA_step.is_assert() && idx++ != claim)
+      SSA_step.ignore = true;
+  }
+
+  if(!options.get_bool_option("no-slice"))
+    slice(claim_eq);
+
+  boost::shared_ptr<smt_convt> claim_solver(
+    create_solver_factory(
+      "",
+      options.get_bool_option("int-encoding"),
+      ns,
+      options));
+
+  smt_convt::resultt res = run_decision_procedure(claim_solver, claim_eq);
+  if(res == smt_convt::P_SATISFIABLE)
+    error_trace(claim_solver, claim_eq);
+
+  return res;
+}
+
+bool bmct::encode_claims(const boost::shared_ptr<symex_target_equationt> &eq)
+{
+  // Dumped formulas are meant to be one per claim
+  if(claims_need_fresh_solver
+     || options.get_bool_option("smt-formula-too")
+     || options.get_bool_option("smt-formula-only"))
+    return false;
+
+  boost::shared_ptr<smt_convt> solver(
+    create_solver_factory(
+      "",
+      options.get_bool_option("int-encoding"),
+      ns,
+      options));
+
+  if(!solver->supports_ctx())
+  {
+    claims_need_fresh_solver = true;
+    return false;
+  }
+
+  solver->set_message_handler(message_handler);
+  solver->set_verbosity(get_verbosity());
+
+  // Slice once for all of the claims together
+  claims_eq =
+    boost::dynamic_pointer_cast<symex_target_equationt>(eq->clone());
+  for(auto &SSA_step : claims_eq->SSA_steps)
+    SSA_step.ignore = false;
+
+  if(!options.get_bool_option("no-slice"))
+    slice(claims_eq);
+
+  std::cout << "Encoding VCC(s) once for all claims\n";
+
+  fine_timet encode_start = current_time();
+
+  // Convert step by step rather than through convert(), which would assert
+  // that some claim fails; that is decided per claim instead.
+  const smt_ast *assumpt_ast = solver->convert_ast(gen_true_expr());
+  smt_convt::ast_vec assertions;
+  for(auto &SSA_step : claims_eq->SSA_steps)
+  {
+    claims_eq->convert_internal_step(*solver, assumpt_ast, assertions, SSA_step);
+    if(SSA_step.is_assert())
+      claim_conds.push_back(SSA_step.cond_ast);
+  }
+
+  fine_timet encode_stop = current_time();
+
+  std::ostringstream str;
+  str << "Encoding to solver time: ";
+  output_time(encode_stop - encode_start, str);
+  str << "s";
+  status(str.str());
+
+  claims_solver = solver;
+  return true;
+}
+
+smt_convt::resultt bmct::run_claim_incrementally(unsigned int claim)
+{
+  assert(claim < claim_conds.size());
+
+  claims_solver->push_ctx();
+  claims_solver->assert_ast(claims_solver->invert_ast(claim_conds[claim]));
+
+  fine_timet sat_start = current_time();
+  smt_convt::resultt res = claims_solver->dec_solve();
+  fine_timet sat_stop = current_time();
+
+  std::ostringstream str;
+  str << "Runtime decision procedure: ";
+  output_time(sat_stop - sat_start, str);
+  str << "s";
+  status(str.str());
+
+  if(res == smt_convt::P_SATISFIABLE)
+  {
+    // Only this claim should show up as violated in the trace, whatever the
+    // model says about the others.
+    const smt_ast *true_ast = claims_solver->convert_ast(gen_true_expr());
+    unsigned int idx = 0;
+    for(auto &SSA_step : claims_eq->SSA_steps)
+      if(SSA_step.is_assert())
+      {
+        SSA_step.cond_ast = (idx == claim) ? claim_conds[idx] : true_ast;
+        idx++;
+      }
+
+    error_trace(claims_solver, claims_eq);
+  }
+
+  claims_solver->pop_ctx();
+
+  // Holds in every model of the equation, so asserting it loses nothing and
+  // may prune the search for the claims still to come.
+  if(res == smt_convt::P_UNSATISFIABLE)
+    claims_solver->assert_ast(claim_conds[claim]);
+
+  return res;
+}
+
+void bmct::report_claim_result(unsigned int claim, smt_convt::resultt res)
+{
+  std::ostringstream str;
+  str << "Claim " << claim + 1 << ": ";
+
+  switch(res)
+  {
+    case smt_convt::P_UNSATISFIABLE:
+      str << "VERIFICATION SUCCESSFUL";
+      break;
+
+    case smt_convt::P_SATISFIABLE:
+      str << "VERIFICATION FAILED";
+      break;
+
+    case smt_convt::P_SMTLIB:
+      str << "SMT formula generated";
+      break;
+
+    default:
+      str << "decision procedure failed";
+      break;
+  }
+
+  status(str.str());
+}
+
+#ifndef _WIN32
+// Record sent from a multi-property worker to the parent for each claim,
+// followed by output_len bytes of the output produced while solving it.
+struct claim_resultt
+{
+  unsigned int claim;
+  smt_convt::resultt res;
+  unsigned int output_len;
+};
+
+static bool write_all(int fd, const char *buf, size_t len)
+{
+  while(len > 0)
+  {
+    ssize_t written = write(fd, buf, len);
+    if(written < 0)
+    {
+      if(errno == EINTR)
+        continue;
+      return true;
+    }
+
+    buf += written;
+    len -= written;
+  }
+
+  return false;
+}
+
+static bool read_all(int fd, char *buf, size_t len)
+{
+  while(len > 0)
+  {
+    ssize_t got = read(fd, buf, len);
+    if(got < 0 && errno == EINTR)
+      continue;
+
+    // Either an error or the worker hung up part way through a record
+    if(got <= 0)
+      return true;
+
+    buf += got;
+    len -= got;
+  }
+
+  return false;
+}
+#endif
+
+smt_convt::resultt bmct::multi_property_check(
+  boost::shared_ptr<symex_target_equationt> &eq)
+{
+  unsigned int num_claims = 0;
+  for(auto const &SSA_step : eq->SSA_steps)
+    if(SSA_step.is_assert())
+      num_claims++;
+
+  unsigned int jobs = std::min(get_num_jobs(options), num_claims);
+
+  // Each interleaving, and each k step run through this bmct, brings a new
+  // equation; an encoding of the previous one is of no use to it.
+  claims_solver.reset();
+  claims_eq.reset();
+  claim_conds.clear();
+  claims_need_fresh_solver = false;
+
+  {
+    std::ostringstream str;
+    str << "Checking " << num_claims << " claim(s) independently using ";
+    str << jobs << " worker(s)";
+    status(str.str());
+  }
+
+  // Unknown until some worker tells us otherwise; claims belonging to a
+  // worker that died are reported as errors.
+  std::vector<smt_convt::resultt> results(num_claims, smt_convt::P_ERROR);
+
+#ifndef _WIN32
+  if(jobs > 1)
+  {
+    // Claims are handed out through a counter shared between the workers, so
+    // that one hard claim doesn't hold up the ones queued behind it.
+    unsigned int *next_claim = static_cast<unsigned int *>(
+      mmap(nullptr, sizeof(unsigned int), PROT_READ | PROT_WRITE,
+           MAP_SHARED | MAP_ANONYMOUS, -1, 0));
+    if(next_claim == MAP_FAILED)
+    {
+      perror("Couldn't map multi-property work counter");
+      return smt_convt::P_ERROR;
+    }
+    *next_claim = 0;
+
+    std::vector<pid_t> children_pid;
+    std::vector<struct pollfd> result_fds;
+
+    // Flush before forking, otherwise buffered output is duplicated
+    std::cout.flush();
+
+    bool spawn_failed = false;
+    for(unsigned int w = 0; w < jobs; ++w)
+    {
+      int result_pipe[2];
+      if(pipe(result_pipe))
+      {
+        perror("Couldn't create pipe for multi-property worker");
+        spawn_failed = true;
+        break;
+      }
+
+      pid_t pid = fork();
+      if(pid == -1)
+      {
+        perror("Couldn't fork multi-property worker");
+        close(result_pipe[0]);
+        close(result_pipe[1]);
+        spawn_failed = true;
+        break;
+      }
+
+      if(!pid)
+      {
+        // Worker: keep taking claims until there are none left. Everything
+        // printed while solving a claim is captured and shipped to the
+        // parent with the verdict, so claims don't interleave their output.
+        close(result_pipe[0]);
+        for(auto const &fd : result_fds)
+          close(fd.fd);
+
+        unsigned int claim;
+        while((claim = __sync_fetch_and_add(next_claim, 1)) < num_claims)
+        {
+          std::ostringstream out;
+          std::streambuf *old_buf = std::cout.rdbuf(out.rdbuf());
+
+          smt_convt::resultt res;
+          try
+          {
+            res = run_claim(eq, claim);
+          }
+          catch(...)
+          {
+            res = smt_convt::P_ERROR;
+          }
+
+          std::cout.rdbuf(old_buf);
+
+          std::string output = out.str();
+          struct claim_resultt r = { claim, res, (unsigned int)output.size() };
+          if(write_all(result_pipe[1], (const char *)&r, sizeof(r))
+             || write_all(result_pipe[1], output.data(), output.size()))
+            _exit(1);
+        }
+
+        close(result_pipe[1]);
+        _exit(0);
+      }
+
+      close(result_pipe[1]);
+      children_pid.push_back(pid);
+      result_fds.push_back({ result_pipe[0], POLLIN, 0 });
+    }
+
+    if(spawn_failed)
+    {
+      // Whatever the workers that did start have taken off the counter would
+      // go missing with them; stop them and check every claim here instead.
+      for(auto const &pid : children_pid)
+        kill(pid, SIGKILL);
+
+      for(auto const &fd : result_fds)
+        close(fd.fd);
+      result_fds.clear();
+
+      status("Checking claims without workers");
+      jobs = 1;
+    }
+
+    // Report each claim as soon as any worker is done with it
+    unsigned int open_fds = result_fds.size();
+    while(open_fds > 0)
+    {
+      if(poll(result_fds.data(), result_fds.size(), -1) < 0)
+      {
+        if(errno == EINTR)
+          continue;
+
+        perror("Couldn't poll multi-property workers");
+        break;
+      }
+
+      for(auto &fd : result_fds)
+      {
+        if(fd.fd < 0 || !(fd.revents & (POLLIN | POLLHUP | POLLERR)))
+          continue;
+
+        struct claim_resultt r;
+        if(read_all(fd.fd, (char *)&r, sizeof(r)))
+        {
+          // Worker finished (or died); stop listening to it
+          close(fd.fd);
+          fd.fd = -1;
+          --open_fds;
+          continue;
+        }
+
+        std::string output(r.output_len, '\0');
+        if(r.claim >= num_claims
+           || read_all(fd.fd, &output[0], r.output_len))
+        {
+          std::cerr << "Short read communicating with multi-property worker"
+                    << std::endl;
+          close(fd.fd);
+          fd.fd = -1;
+          --open_fds;
+          continue;
+        }
+
+        std::cout << output;
+        results[r.claim] = r.res;
+        report_claim_result(r.claim, r.res);
+      }
+    }
+
+    for(auto const &pid : children_pid)
+    {
+      int status;
+      waitpid(pid, &status, 0);
+    }
+
+    munmap(next_claim, sizeof(unsigned int));
+  }
+
+  if(jobs <= 1)
+#endif
+  {
+    for(unsigned int claim = 0; claim < num_claims; ++claim)
+    {
+      results[claim] = run_claim(eq, claim);
+      report_claim_result(claim, results[claim]);
+    }
+  }
+
+  unsigned int failed = 0, errors = 0;
+  for(auto const &res : results)
+  {
+    if(res == smt_convt::P_SATISFIABLE)
+      ++failed;
+    else if(res != smt_convt::P_UNSATISFIABLE && res != smt_convt::P_SMTLIB)
+      ++errors;
+  }
+
+  {
+    std::ostringstream str;
+    str << "Multi-property summary: " << num_claims - failed - errors;
+    str << " claim(s) hold, " << failed << " violated, " << errors;
+    str << " unknown";
+    status(str.str());
+  }
+
+  if(failed > 0)
+    return smt_convt::P_SATISFIABLE;
+
+  if(errors > 0)
+    return smt_convt::P_ERROR;
+
+  if(options.get_bool_option("smt-formula-only"))
+    return smt_convt::P_SMTLIB;
+
+  return smt_convt::P_UNSATISFIABLE;
+}
+
+#ifndef _WIN32
+// Sent by a portfolio entrant once it has a verdict, followed by output_len
+// bytes of what it printed and record_len bytes of formula cache record.
+struct portfolio_resultt
+{
+  smt_convt::resultt res;
+  unsigned int output_len;
+  unsigned int record_len;
+};
+#endif
+
+smt_convt::resultt bmct::run_portfolio_decision_procedure(
+  boost::shared_ptr<symex_target_equationt> &eq)
+{
+#ifdef _WIN32
+  error("--portfolio is not supported on Windows");
+  return smt_convt::P_ERROR;
+#else
+  // Every solver built in, under the requested encoding and, if asked, the
+  // other one too. The smtlib backend is only an entrant when it has a
+  // program to talk to.
+  std::vector<std::pair<std::string, bool> > entrants;
+  bool int_encoding = options.get_bool_option("int-encoding");
+  for(unsigned int i = 0; i < esbmc_num_solvers; i++)
+  {
+    std::string name = esbmc_solvers[i].name;
+    if(name == "smtlib" && options.get_option("smtlib-solver-prog").empty())
+      continue;
+
+    entrants.emplace_back(name, int_encoding);
+    if(options.get_bool_option("portfolio-int-encoding"))
+      entrants.emplace_back(name, !int_encoding);
+  }
+
+  if(entrants.empty())
+  {
+    error("--portfolio: no solver available to race");
+    return smt_convt::P_ERROR;
+  }
+
+  {
+    std::ostringstream str;
+    str << "Racing " << entrants.size() << " solver configuration(s)";
+    status(str.str());
+  }
+
+  std::vector<pid_t> children_pid;
+  std::vector<struct pollfd> result_fds;
+
+  // Flush before forking, otherwise buffered output is duplicated
+  std::cout.flush();
+
+  fine_timet race_start = current_time();
+
+  bool spawn_failed = false;
+  for(auto const &entrant : entrants)
+  {
+    int result_pipe[2];
+    if(pipe(result_pipe))
+    {
+      perror("Couldn't create pipe for portfolio solver");
+      spawn_failed = true;
+      break;
+    }
+
+    pid_t pid = fork();
+    if(pid == -1)
+    {
+      perror("Couldn't fork portfolio solver");
+      close(result_pipe[0]);
+      close(result_pipe[1]);
+      spawn_failed = true;
+      break;
+    }
+
+    if(!pid)
+    {
+      // Entrant: a process group of its own, so that the losers can be
+      // killed along with any solver program they spawned.
+      setpgid(0, 0);
+      close(result_pipe[0]);
+      for(auto const &fd : result_fds)
+        close(fd.fd);
+
+      std::ostringstream out, record;
+      std::streambuf *old_buf = std::cout.rdbuf(out.rdbuf());
+
+      smt_convt::resultt res;
+      try
+      {
+        boost::shared_ptr<smt_convt> solver(
+          create_solver_factory(entrant.first, entrant.second, ns, options));
+        res = run_decision_procedure(solver, eq);
+        if(res == smt_convt::P_SATISFIABLE
+           || res == smt_convt::P_UNSATISFIABLE)
+          formula_cachet::write_record(record, *eq, res, *solver);
+      }
+      catch(...)
+      {
+        res = smt_convt::P_ERROR;
+      }
+
+      std::cout.rdbuf(old_buf);
+
+      std::string output = out.str(), rec = record.str();
+      struct portfolio_resultt r =
+        { res, (unsigned int)output.size(), (unsigned int)rec.size() };
+      if(write_all(result_pipe[1], (const char *)&r, sizeof(r))
+         || write_all(result_pipe[1], output.data(), output.size())
+         || write_all(result_pipe[1], rec.data(), rec.size()))
+        _exit(1);
+
+      close(result_pipe[1]);
+      _exit(0);
+    }
+
+    // Also set here, in case the parent gets to kill it first
+    setpgid(pid, pid);
+    close(result_pipe[1]);
+    children_pid.push_back(pid);
+    result_fds.push_back({ result_pipe[0], POLLIN, 0 });
+  }
+
+  if(spawn_failed)
+  {
+    // Stop the entrants that did start, and decide the formula here with
+    // the default solver instead.
+    for(auto const &pid : children_pid)
+      kill(-pid, SIGKILL);
+
+    for(auto const &pid : children_pid)
+    {
+      int status;
+      waitpid(pid, &status, 0);
+    }
+
+    for(auto const &fd : result_fds)
+      close(fd.fd);
+
+    status("Solving without the portfolio");
+    runtime_solver =
+      boost::shared_ptr<smt_convt>(
+        create_solver_factory("", int_encoding, ns, options));
+    return run_decision_procedure(runtime_solver, eq);
+  }
+
+  // Wait for the first entrant with a definite verdict. Those that give up,
+  // crash or don't know are simply dropped from the race.
+  smt_convt::resultt res = smt_convt::P_ERROR;
+  int winner = -1;
+  unsigned int open_fds = result_fds.size();
+  while(open_fds > 0 && winner < 0)
+  {
+    if(poll(result_fds.data(), result_fds.size(), -1) < 0)
+    {
+      if(errno == EINTR)
+        continue;
+
+      perror("Couldn't poll portfolio solvers");
+      break;
+    }
+
+    for(unsigned int i = 0; i < result_fds.size() && winner < 0; i++)
+    {
+      struct pollfd &fd = result_fds[i];
+      if(fd.fd < 0 || !(fd.revents & (POLLIN | POLLHUP | POLLERR)))
+        continue;
+
+      struct portfolio_resultt r;
+      std::string output, record;
+      bool failed = read_all(fd.fd, (char *)&r, sizeof(r));
+      if(!failed)
+      {
+        output.resize(r.output_len);
+        record.resize(r.record_len);
+        failed = read_all(fd.fd, &output[0], r.output_len)
+                 || read_all(fd.fd, &record[0], r.record_len);
+      }
+
+      close(fd.fd);
+      fd.fd = -1;
+      --open_fds;
+
+      if(failed
+         || (r.res != smt_convt::P_SATISFIABLE
+             && r.res != smt_convt::P_UNSATISFIABLE))
+        continue;
+
+      smt_convt::resultt record_res;
+      goto_tracet goto_trace;
+      std::istringstream in(record);
+      if(!formula_cachet::read_record(in, *eq, record_res, goto_trace)
+         || record_res != r.res)
+      {
+        std::cerr << "Bad result record from portfolio solver "
+                  << entrants[i].first << std::endl;
+        continue;
+      }
+
+      std::cout << output;
+      winner = i;
+      res = r.res;
+      if(res == smt_convt::P_SATISFIABLE)
+        cached_trace = std::make_shared<goto_tracet>(goto_trace);
+    }
+  }
+
+  fine_timet race_stop = current_time();
+
+  for(auto const &pid : children_pid)
+    kill(-pid, SIGKILL);
+
+  for(auto const &pid : children_pid)
+  {
+    int status;
+    waitpid(pid, &status, 0);
+  }
+
+  for(auto const &fd : result_fds)
+    if(fd.fd >= 0)
+      close(fd.fd);
+
+  runtime_solver.reset();
+
+  std::ostringstream str;
+  if(winner < 0)
+    str << "No solver in the portfolio reached a verdict";
+  else
+  {
+    str << "Portfolio won by " << entrants[winner].first << " ("
+        << (entrants[winner].second ? "integer/real" : "bit-vector")
+        << " encoding) after ";
+    output_time(race_stop - race_start, str);
+    str << "s";
+  }
+  status(str.str());
+
+  return res;
+#endif
+}
+
+#ifndef _WIN32
+// Shared by all the processes exploring interleavings in parallel, followed
+// by one pid per worker slot. Slot 0 is the process that started exploring;
+// a free slot holds 0, and one whose worker is being forked holds -1.
+struct ileave_boardt
+{
+  // Held while a worker copies an interleaving's output to stdout
+  sem_t output_lock;
+  // Posted whenever a worker checks out
+  sem_t finished;
+  volatile uint64_t interleaving_number;
+  volatile uint64_t interleaving_failed;
+  // Set when the exploration should wind down: a violation was reported
+  // (without --all-runs), or something went wrong
+  volatile int stop;
+  volatile int error;
+  unsigned int num_slots;
+};
+
+static volatile pid_t *ileave_board_slots(ileave_boardt *board)
+{
+  return reinterpret_cast<volatile pid_t *>(board + 1);
+}
+
+smt_convt::resultt bmct::run_parallel_interleavings(
+  boost::shared_ptr<symex_target_equationt> &eq)
+{
+  unsigned int jobs = get_num_jobs(options);
+  bool all_runs = options.get_bool_option("all-runs");
+
+  size_t board_size = sizeof(ileave_boardt) + jobs * sizeof(pid_t);
+  void *mem = mmap(nullptr, board_size, PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  if(mem == MAP_FAILED)
+  {
+    perror("Couldn't map interleaving board");
+    return smt_convt::P_ERROR;
+  }
+
+  ileave_boardt *board = static_cast<ileave_boardt *>(mem);
+  sem_init(&board->output_lock, 1, 1);
+  sem_init(&board->finished, 1, 0);
+  board->num_slots = jobs;
+
+  volatile pid_t *slots = ileave_board_slots(board);
+  slots[0] = getpid();
+
+  // Workers all prune against the same set of state hashes
+  std::shared_ptr<state_hash_sett> private_hashes = symex->hit_hashes;
+  if(options.get_bool_option("state-hashing"))
+    symex->hit_hashes = std::make_shared<state_hash_sett>(22, true);
+
+  // Unexplored context switches found while backtracking are handed to a new
+  // worker whenever a slot is free; workers hand out work in the same way.
+  unsigned int my_slot = 0;
+  symex->fork_worker = [board, slots, &my_slot]() -> int
+  {
+    if(board->stop)
+      return -1;
+
+    // Reap any worker we started that has since checked out
+    while(waitpid(-1, nullptr, WNOHANG) > 0)
+      ;
+
+    unsigned int slot;
+    for(slot = 1; slot < board->num_slots; ++slot)
+      if(__sync_bool_compare_and_swap(&slots[slot], 0, -1))
+        break;
+
+    if(slot == board->num_slots)
+      return -1;
+
+    // Flush before forking, otherwise buffered output is duplicated
+    std::cout.flush();
+
+    pid_t pid = fork();
+    if(pid < 0)
+    {
+      slots[slot] = 0;
+      return -1;
+    }
+
+    if(pid == 0)
+    {
+      my_slot = slot;
+      __sync_bool_compare_and_swap(&slots[slot], -1, getpid());
+      return 0;
+    }
+
+    __sync_bool_compare_and_swap(&slots[slot], -1, pid);
+    return pid;
+  };
+
+  smt_convt::resultt res = smt_convt::P_UNSATISFIABLE;
+
+  do
+  {
+    if(board->stop)
+      break;
+
+    uint64_t number = __sync_add_and_fetch(&board->interleaving_number, 1);
+
+    // Capture everything printed for this interleaving, so that it comes out
+    // in one piece rather than mixed up with other workers' output
+    std::ostringstream out;
+    std::streambuf *old_buf = std::cout.rdbuf(out.rdbuf());
+
+    if(number > 1)
+    {
+      std::cout << "*** Thread interleavings " << number << " ***"
+                << std::endl;
+    }
+
+    fine_timet bmc_start = current_time();
+    smt_convt::resultt ileave_res = run_thread(eq);
+    bool show = true;
+    if(ileave_res)
+    {
+      res = ileave_res;
+
+      if(ileave_res == smt_convt::P_SATISFIABLE)
+        __sync_add_and_fetch(&board->interleaving_failed, 1);
+      else if(ileave_res == smt_convt::P_ERROR)
+        board->error = 1;
+
+      // Only the first worker to fail gets to report it
+      if(!all_runs)
+        show = __sync_bool_compare_and_swap(&board->stop, 0, 1);
+
+      if(show)
+        report_trace(ileave_res, eq);
+    }
+
+    if(all_runs || !ileave_res)
+    {
+      fine_timet bmc_stop = current_time();
+
+      std::ostringstream str;
+      str << "BMC program time: ";
+      output_time(bmc_stop-bmc_start, str);
+      str << "s";
+      status(str.str());
+    }
+
+    std::cout.rdbuf(old_buf);
+
+    if(show)
+    {
+      sem_wait(&board->output_lock);
+      std::cout << out.str() << std::flush;
+      sem_post(&board->output_lock);
+    }
+
+    if(ileave_res && !all_runs)
+      break;
+
+  } while(symex->setup_next_formula());
+
+  symex->fork_worker = nullptr;
+
+  if(my_slot != 0)
+  {
+    // A worker: our findings are on the board
+    slots[my_slot] = 0;
+    sem_post(&board->finished);
+    _exit(0);
+  }
+
+  // Wait for the workers to check out, noticing any that die without doing
+  // so. Workers can be started by other workers, so they are not all our
+  // children: poll for their existence instead.
+  for(;;)
+  {
+    while(waitpid(-1, nullptr, WNOHANG) > 0)
+      ;
+
+    bool live = false;
+    for(unsigned int slot = 1; slot < board->num_slots; ++slot)
+    {
+      pid_t pid = slots[slot];
+      if(pid == 0)
+        continue;
+
+      if(pid > 0 && kill(pid, 0) != 0 && errno == ESRCH)
+      {
+        if(__sync_bool_compare_and_swap(&slots[slot], pid, 0))
+        {
+          std::cerr << "Interleaving worker " << pid << " died" << std::endl;
+          board->error = 1;
+        }
+        continue;
+      }
+
+      live = true;
+    }
+
+    if(!live)
+      break;
+
+    struct timespec timeout;
+    clock_gettime(CLOCK_REALTIME, &timeout);
+    ++timeout.tv_sec;
+    sem_timedwait(&board->finished, &timeout);
+  }
+
+  interleaving_number = (BigInt::ullong_t) board->interleaving_number;
+  interleaving_failed = (BigInt::ullong_t) board->interleaving_failed;
+  bool error = board->error;
+
+  if(options.get_bool_option("memstats") && symex->hit_hashes)
+    symex->hit_hashes->output_stats(std::cout);
+  symex->hit_hashes = private_hashes;
+  sem_destroy(&board->output_lock);
+  sem_destroy(&board->finished);
+  munmap(mem, board_size);
+
+  if(interleaving_failed > 0)
+    return smt_convt::P_SATISFIABLE;
+
+  if(error)
+    return smt_convt::P_ERROR;
+
+  return res;
+}
+#endif
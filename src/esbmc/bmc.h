@@ -61,6 +61,21 @@ protected:
     boost::shared_ptr<smt_convt> &smt_conv,
     boost::shared_ptr<symex_target_equationt> &eq);
 
+  // Consult the --formula-cache directory before building a solver, and
+  // record the verdict afterwards.
+  smt_convt::resultt run_cached_decision_procedure(
+    boost::shared_ptr<symex_target_equationt> &eq);
+
+  // Solve eq with every available solver at once, in forked children, and
+  // keep the first definite verdict. The winner's counterexample is sent back
+  // and replayed through cached_trace.
+  smt_convt::resultt run_portfolio_decision_procedure(
+    boost::shared_ptr<symex_target_equationt> &eq);
+
+  // Counterexample replayed from a formula cache hit, used by error_trace in
+  // place of querying runtime_solver.
+  std::shared_ptr<goto_tracet> cached_trace;
+
   virtual void do_cbmc(
     boost::shared_ptr<smt_convt> &smt_conv,
     boost::shared_ptr<symex_target_equationt> &eq);
@@ -88,7 +103,50 @@ protected:
   virtual void report_result(smt_convt::resultt &res);
 
   smt_convt::resultt run_thread(boost::shared_ptr<symex_target_equationt> &eq);
+
+  // Explore interleavings with a pool of --jobs forked workers, each taking
+  // over subtrees of the reachability tree as it backtracks into them
+  smt_convt::resultt run_parallel_interleavings(
+    boost::shared_ptr<symex_target_equationt> &eq);
   int ltl_run_thread(boost::shared_ptr<symex_target_equationt> &eq);
+
+  // Multi-property checking: slice and solve every remaining claim on its own
+  smt_convt::resultt multi_property_check(
+    boost::shared_ptr<symex_target_equationt> &eq);
+
+  smt_convt::resultt run_claim(
+    const boost::shared_ptr<symex_target_equationt> &eq,
+    unsigned int claim);
+
+  void report_claim_result(unsigned int claim, smt_convt::resultt res);
+
+  // Incremental base case: one solver is kept alive across k steps, holding
+  // the encoding of the equation prefix shared by consecutive unrollings.
+  smt_convt::resultt run_incremental_decision_procedure(
+    boost::shared_ptr<symex_target_equationt> &eq);
+
+  boost::shared_ptr<smt_convt> inc_solver;
+  boost::shared_ptr<symex_target_equationt> inc_eq;
+  unsigned int inc_committed;
+  const smt_ast *inc_assumpt_ast;
+  smt_convt::ast_vec inc_assertions;
+  bool inc_ctx_pushed;
+
+  // Claims checked against a single encoding of the whole equation: each
+  // claim's negation is asserted in a context of its own, and claims that
+  // were proven stay behind as lemmas for the ones after them. Only used
+  // with solvers that support contexts.
+  bool encode_claims(const boost::shared_ptr<symex_target_equationt> &eq);
+  smt_convt::resultt run_claim_incrementally(unsigned int claim);
+
+  boost::shared_ptr<smt_convt> claims_solver;
+  boost::shared_ptr<symex_target_equationt> claims_eq;
+  std::vector<smt_astt> claim_conds;
+  bool claims_need_fresh_solver;
 };
 
+// Number of worker processes to use for the parallel modes; --jobs, or the
+// number of online processors if that wasn't given.
+unsigned int get_num_jobs(const optionst &options);
+
 #endif
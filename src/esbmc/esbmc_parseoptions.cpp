@@ -17,6 +17,8 @@ extern "C" {
 #include <sys/sendfile.h>
 #endif
 
+#include <semaphore.h>
+#include <sys/mman.h>
 #include <sys/resource.h>
 #include <sys/time.h>
 #include <sys/types.h>
@@ -27,10 +29,12 @@ extern "C" {
 #include <esbmc/esbmc_parseoptions.h>
 #include <ansi-c/c_preprocess.h>
 #include <cctype>
+#include <cerrno>
 #include <clang-c-frontend/clang_c_language.h>
 #include <util/config.h>
 #include <csignal>
 #include <cstdlib>
+#include <cstring>
 #include <util/expr_util.h>
 #include <fstream>
 #include <goto-programs/add_race_assertions.h>
@@ -39,6 +43,7 @@ extern "C" {
 #include <goto-programs/goto_inline.h>
 #include <goto-programs/goto_k_induction.h>
 #include <goto-programs/goto_unwind.h>
+#include <goto-programs/interval_analysis.h>
 #include <goto-programs/loop_numbers.h>
 #include <goto-programs/read_goto_binary.h>
 #include <goto-programs/remove_skip.h>
@@ -46,6 +51,7 @@ extern "C" {
 #include <goto-programs/set_claims.h>
 #include <goto-programs/show_claims.h>
 #include <util/irep.h>
+#include <util/irep2.h>
 #include <langapi/languages.h>
 #include <langapi/mode.h>
 #include <memory>
@@ -58,12 +64,118 @@ extern "C" {
 
 enum PROCESS_TYPE { BASE_CASE, FORWARD_CONDITION, INDUCTIVE_STEP, PARENT };
 
-struct resultt
+// One slot of the parallel k-induction result board per worker process
+struct kind_workert
 {
   PROCESS_TYPE type;
-  u_int k;
+  pid_t pid;
+  // k currently being checked, or zero when between k steps
+  volatile uint64_t k;
+  // Set by the scheduler before it kills the worker
+  bool cancelled;
 };
 
+// Result board shared between the parallel k-induction scheduler and its
+// workers; followed in memory by one kind_workert per worker. Every k value
+// is zero until something has been found.
+struct kind_boardt
+{
+  // Posted whenever a worker updates the board, or dies
+  sem_t updated;
+  // Next k to be handed out, per strategy
+  uint64_t next_k[3];
+  uint64_t k_step_inc;
+  // Smallest k at which the base case found a bug
+  volatile uint64_t bug_k;
+  // Largest k at which the base case found no bug; that covers all smaller k
+  volatile uint64_t safe_k;
+  // Smallest k at which the forward condition / inductive step succeeded
+  volatile uint64_t proof_k[3];
+};
+
+static kind_workert *kind_board_workers(kind_boardt *board)
+{
+  return reinterpret_cast<kind_workert *>(board + 1);
+}
+
+static const char *kind_type_name(PROCESS_TYPE type)
+{
+  switch(type)
+  {
+    case BASE_CASE:
+      return "base case";
+    case FORWARD_CONDITION:
+      return "forward condition";
+    case INDUCTIVE_STEP:
+      return "inductive step";
+    default:
+      return "parent";
+  }
+}
+
+static void kind_board_min(volatile uint64_t *v, uint64_t k)
+{
+  uint64_t old = *v;
+  while((old == 0 || k < old)
+        && !__sync_bool_compare_and_swap(v, old, k))
+    old = *v;
+}
+
+static void kind_board_max(volatile uint64_t *v, uint64_t k)
+{
+  uint64_t old = *v;
+  while(k > old && !__sync_bool_compare_and_swap(v, old, k))
+    old = *v;
+}
+
+// Smallest k at which either the forward condition or the inductive step
+// succeeded, if the base case has caught up with it.
+static uint64_t kind_proof_k(const kind_boardt *board)
+{
+  uint64_t fc = board->proof_k[FORWARD_CONDITION];
+  uint64_t is = board->proof_k[INDUCTIVE_STEP];
+
+  if(fc != 0 && board->safe_k >= fc)
+    return fc;
+
+  if(is != 0 && board->safe_k >= is)
+    return is;
+
+  return 0;
+}
+
+// Whether checking k with the given strategy can still change the outcome.
+// Once a proof is known at some k, only a base case run at or above that k
+// is still needed: base case runs subsume all smaller bounds, and the first k
+// handed out at or above the proof is always running or done.
+static bool kind_dominated(
+  const kind_boardt *board,
+  PROCESS_TYPE type,
+  uint64_t k)
+{
+  uint64_t fc = board->proof_k[FORWARD_CONDITION];
+  uint64_t is = board->proof_k[INDUCTIVE_STEP];
+  uint64_t proof = (fc != 0 && (is == 0 || fc < is)) ? fc : is;
+
+  if(proof == 0)
+    return false;
+
+  if(type == BASE_CASE)
+    return k >= proof + board->k_step_inc;
+
+  return k >= proof;
+}
+
+static sem_t *kind_board_sem = nullptr;
+
+static void kind_child_handler(int dummy __attribute__((unused)))
+{
+  int saved_errno = errno;
+  if(kind_board_sem != nullptr)
+    sem_post(kind_board_sem);
+  errno = saved_errno;
+}
+
 #ifndef _WIN32
 void
 timeout_handler(int dummy __attribute__((unused)))
@@ -161,6 +273,8 @@ uint64_t cbmc_parseoptionst::read_mem_spec(const char *str)
 
 void cbmc_parseoptionst::get_command_line_options(optionst &options)
 {
+  irep2_hash_consing = cmdline.isset("hash-consing");
+
   if(config.set(cmdline))
   {
     exit(1);
@@ -223,6 +337,51 @@ void cbmc_parseoptionst::get_command_line_options(optionst &options)
     options.set_option("no-slice", true);
   }
 
+  if(cmdline.isset("incremental-base-case") &&
+     (cmdline.isset("smt-during-symex") || cmdline.isset("multi-property")))
+  {
+    std::cerr << "--incremental-base-case can't be combined with "
+        "--smt-during-symex or --multi-property" << std::endl;
+    abort();
+  }
+
+  if(cmdline.isset("multi-property") &&
+     (cmdline.isset("smt-during-symex") || cmdline.isset("ltl")))
+  {
+    std::cerr << "--multi-property can't be combined with --smt-during-symex "
+        "or --ltl" << std::endl;
+    abort();
+  }
+
+  if(cmdline.isset("parallel-interleavings") &&
+     (cmdline.isset("schedule") || cmdline.isset("interactive-ileaves") ||
+      cmdline.isset("ltl") || cmdline.isset("smt-during-symex") ||
+      cmdline.isset("multi-property") || cmdline.isset("k-induction-parallel")))
+  {
+    std::cerr << "--parallel-interleavings can't be combined with --schedule, "
+        "--interactive-ileaves, --ltl, --smt-during-symex, --multi-property "
+        "or --k-induction-parallel" << std::endl;
+    abort();
+  }
+
+  if(cmdline.isset("formula-cache") && cmdline.isset("smt-during-symex"))
+  {
+    std::cerr << "--formula-cache can't be combined with --smt-during-symex"
+              << std::endl;
+    abort();
+  }
+
+  if(cmdline.isset("portfolio") &&
+     (cmdline.isset("smt-during-symex") || cmdline.isset("multi-property") ||
+      cmdline.isset("incremental-base-case") || cmdline.isset("formula-cache") ||
+      cmdline.isset("smt-formula-only") || cmdline.isset("smt-formula-too")))
+  {
+    std::cerr << "--portfolio can't be combined with --smt-during-symex, "
+        "--multi-property, --incremental-base-case, --formula-cache, "
+        "--smt-formula-only or --smt-formula-too" << std::endl;
+    abort();
+  }
+
   if(cmdline.isset("smt-thread-guard") || cmdline.isset("smt-symex-guard"))
   {
     if(!cmdline.isset("smt-during-symex"))
@@ -394,32 +553,76 @@ int cbmc_parseoptionst::doit()
 
 int cbmc_parseoptionst::doit_k_induction_parallel()
 {
-  // Pipes for communication between processes
-  int forward_pipe[2], backward_pipe[2];
+  // All workers run on the same goto program; build it once before forking
+  optionst opts;
+  get_command_line_options(opts);
 
-  // Process type
-  PROCESS_TYPE process_type = PARENT;
+  if(get_goto_program(opts, goto_functions))
+    return 6;
 
-  if(pipe(forward_pipe))
+  if(cmdline.isset("show-claims"))
   {
-    status("\nPipe Creation Failed, giving up.");
-    _exit(1);
+    const namespacet ns(context);
+    show_claims(ns, get_ui(), goto_functions);
+    return 0;
   }
 
-  if(pipe(backward_pipe))
+  if(set_claims(goto_functions))
+    return 7;
+
+  // Get max number of iterations
+  u_int max_k_step = strtoul(cmdline.getval("max-k-step"), nullptr, 10);
+
+  // The option unlimited-k-steps set the max number of iterations to UINT_MAX
+  if(cmdline.isset("unlimited-k-steps"))
+    max_k_step = UINT_MAX;
+
+  // Get the increment
+  unsigned k_step_inc = strtoul(cmdline.getval("k-step"), nullptr, 10);
+
+  // At least one worker per strategy; the rest are shared out between them
+  // in turn, starting with the base case.
+  unsigned int jobs = std::max(3u, get_num_jobs(opts));
+
+  size_t board_size = sizeof(kind_boardt) + jobs * sizeof(kind_workert);
+  void *mem = mmap(nullptr, board_size, PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  if(mem == MAP_FAILED)
   {
-    status("\nPipe Creation Failed, giving up.");
-    _exit(1);
+    perror("Couldn't map k-induction result board");
+    return 1;
   }
 
-  /* Set file descriptor non-blocking */
-  fcntl(backward_pipe[0], F_SETFL, fcntl(backward_pipe[0], F_GETFL) | O_NONBLOCK);
+  kind_boardt *board = new (mem) kind_boardt();
+  kind_workert *workers = kind_board_workers(board);
+  if(sem_init(&board->updated, 1, 0))
+  {
+    perror("Couldn't create k-induction result board semaphore");
+    return 1;
+  }
+
+  board->next_k[BASE_CASE] = 1;
+  board->next_k[FORWARD_CONDITION] = 2;
+  board->next_k[INDUCTIVE_STEP] = 2;
+  board->k_step_inc = k_step_inc;
+
+  for(unsigned int w = 0; w < jobs; ++w)
+    workers[w].type = PROCESS_TYPE(w % 3);
 
-  pid_t children_pid[3];
-  short num_p = 0;
+  // Dying children wake the scheduler up just like board updates do
+  kind_board_sem = &board->updated;
+  struct sigaction sa, old_sa;
+  memset(&sa, 0, sizeof(sa));
+  sa.sa_handler = kind_child_handler;
+  sa.sa_flags = SA_RESTART | SA_NOCLDSTOP;
+  sigemptyset(&sa.sa_mask);
+  sigaction(SIGCHLD, &sa, &old_sa);
 
-  // We need to fork 3 times: one for each step
-  for(u_int p = 0; p < 3; ++p)
+  // Flush before forking, otherwise buffered output is duplicated
+  std::cout.flush();
+
+  unsigned int live = 0;
+  for(unsigned int w = 0; w < jobs; ++w)
   {
     pid_t pid = fork();
 
@@ -429,537 +632,211 @@ int cbmc_parseoptionst::doit_k_induction_parallel()
       _exit(1);
     }
 
-    // Child process
     if(!pid)
     {
-      process_type = PROCESS_TYPE(p);
-      break;
+      sigaction(SIGCHLD, &old_sa, nullptr);
+      run_k_induction_worker(opts, board, w, max_k_step);
+      std::cout.flush();
+      _exit(0);
     }
-    else // Parent process
-    {
-      children_pid[p] = pid;
-      ++num_p;
-    }
-  }
 
-  if(process_type == PARENT && num_p != 3)
-  {
-    std::cerr << "Child processes were not created sucessfully." << std::endl;
-    abort();
+    workers[w].pid = pid;
+    ++live;
   }
 
-  optionst opts;
-
-  if(process_type != PARENT)
+  bool give_up = false;
+  while(live > 0)
   {
-    // Get full set of options
-    get_command_line_options(opts);
+    while(sem_wait(&board->updated) == -1 && errno == EINTR)
+      ;
 
-    // Generate goto functions and set claims
-    if(get_goto_program(opts, goto_functions))
-      return 6;
-
-    if(cmdline.isset("show-claims"))
+    // Collect whoever has finished since we last looked
+    int status;
+    pid_t pid;
+    while((pid = waitpid(-1, &status, WNOHANG)) > 0)
     {
-      const namespacet ns(context);
-      show_claims(ns, get_ui(), goto_functions);
-      return 0;
-    }
-
-    if(set_claims(goto_functions))
-      return 7;
-  }
-
-  // Get max number of iterations
-  u_int max_k_step = strtoul(cmdline.getval("max-k-step"), nullptr, 10);
-
-  // The option unlimited-k-steps set the max number of iterations to UINT_MAX
-  if(cmdline.isset("unlimited-k-steps"))
-    max_k_step = UINT_MAX;
-
-  // Get the increment
-  unsigned k_step_inc = strtoul(cmdline.getval("k-step"), nullptr, 10);
-
-  // All processes were created successfully
-  switch(process_type)
-  {
-    case PARENT:
-    {
-      // Communication to child processes
-      close(forward_pipe[1]);
-      close(backward_pipe[0]);
-
-      struct resultt a_result;
-      bool bc_finished = false, fc_finished = false, is_finished = false;
-      u_int bc_solution = max_k_step, fc_solution = max_k_step, is_solution = max_k_step;
-
-      // Keep reading until we find an answer
-      while(!(bc_finished && fc_finished && is_finished))
+      for(unsigned int w = 0; w < jobs; ++w)
       {
-        // Perform read and interpret the number of bytes read
-        int read_size = read(forward_pipe[0], &a_result, sizeof(resultt));
-        if(read_size != sizeof(resultt))
-        {
-          if(read_size == 0)
-          {
-            // Client hung up; continue on, but don't interpret the result.
-            ;
-          }
-          else
-          {
-            // Invalid size read.
-            std::cerr << "Short read communicating with kinduction children"
-                << std::endl;
-            std::cerr << "Size " << read_size << ", expected "
-                << sizeof(resultt) << std::endl;
-            abort();
-          }
-        }
-
-        // Eventually the parent process will check if the child process is alive
-
-        // Check base case process
-        if(!bc_finished)
-        {
-          int status;
-          pid_t result = waitpid(children_pid[0], &status, WNOHANG);
-          if(result == 0)
-          {
-            // Child still alive
-          }
-          else if(result == -1)
-          {
-            // Error
-          }
-          else
-          {
-            std::cout << "**** WARNING: Base case process crashed." << std::endl;
-
-            bc_finished = true;
-            if(cmdline.isset("dont-ignore-dead-child-process"))
-              fc_finished = is_finished = true;
-          }
-        }
-
-        // Check forward condition process
-        if(!fc_finished)
-        {
-          int status;
-          pid_t result = waitpid(children_pid[1], &status, WNOHANG);
-          if(result == 0)
-          {
-            // Child still alive
-          }
-          else if(result == -1)
-          {
-            // Error
-          }
-          else
-          {
-            std::cout << "**** WARNING: Forward condition process crashed." << std::endl;
-
-            fc_finished = true;
-            if(cmdline.isset("dont-ignore-dead-child-process"))
-              bc_finished = is_finished = true;
-          }
-        }
-
-        // Check inductive step process
-        if(!is_finished)
-        {
-          int status;
-          pid_t result = waitpid(children_pid[2], &status, WNOHANG);
-          if(result == 0)
-          {
-            // Child still alive
-          }
-          else if(result == -1)
-          {
-            // Error
-          }
-          else
-          {
-            std::cout << "**** WARNING: Inductive step process crashed." << std::endl;
+        if(workers[w].pid != pid)
+          continue;
 
-            is_finished = true;
-            if(cmdline.isset("dont-ignore-dead-child-process"))
-              bc_finished = fc_finished = true;
-          }
-        }
+        workers[w].pid = 0;
+        --live;
 
-        switch(a_result.type)
+        if(!workers[w].cancelled
+           && !(WIFEXITED(status) && WEXITSTATUS(status) == 0))
         {
-          case BASE_CASE:
-            bc_finished = true;
-            bc_solution = a_result.k;
-            break;
+          std::cout << "**** WARNING: " << kind_type_name(workers[w].type)
+                    << " process crashed." << std::endl;
 
-          case FORWARD_CONDITION:
-            fc_finished = true;
-            fc_solution = a_result.k;
-            break;
-
-          case INDUCTIVE_STEP:
-            is_finished = true;
-            is_solution = a_result.k;
-            break;
-
-          default:
-            std::cerr << "Message from unrecognized k-induction child "
-                << "process" << std::endl;
-            abort();
-        }
-
-        // If either the base case found a bug or the forward condition
-        // finds a solution, present the result
-        if(bc_finished && (bc_solution != 0) && (bc_solution != max_k_step))
-          break;
-
-        // If the either the forward condition or inductive step finds a
-        // solution, first check if base case couldn't find a bug in that code,
-        // if there is no bug, inductive step can present the result
-
-        if(fc_finished && (fc_solution != 0) && (fc_solution != max_k_step))
-        {
-          // If base case finished, then we can present the result
-          if(bc_finished)
-            break;
-
-          // Otherwise, ask base case for a solution
-
-          // Struct to keep the result
-          struct resultt r = { process_type, 0 };
-
-          r.k = fc_solution;
-
-          // Write result
-          u_int len = write(backward_pipe[1], &r, sizeof(r));
-          assert(len == sizeof(r) && "short write");
-          (void)len; //ndebug
-        }
-
-        if(is_finished && (is_solution != 0) && (is_solution != max_k_step))
-        {
-          // If base case finished, then we can present the result
-          if(bc_finished)
-            break;
-
-          // Otherwise, ask base case for a solution
-
-          // Struct to keep the result
-          struct resultt r = { process_type, 0 };
-
-          r.k = is_solution;
-
-          // Write result
-          u_int len = write(backward_pipe[1], &r, sizeof(r));
-          assert(len == sizeof(r) && "short write");
-          (void)len; //ndebug
+          if(cmdline.isset("dont-ignore-dead-child-process"))
+            give_up = true;
         }
       }
+    }
 
-      for(int i : children_pid)
-        kill(i, SIGKILL);
-
-      // Check if a solution was found by the base case
-      if(bc_finished && (bc_solution != 0) && (bc_solution != max_k_step))
-      {
-        std::cout << std::endl << "Bug found by the base case (k = "
-            << bc_solution << ")" << std::endl;
-        std::cout << "VERIFICATION FAILED" << std::endl;
-        return true;
-      }
+    if(board->bug_k != 0 || kind_proof_k(board) != 0 || give_up)
+      break;
 
-      // Check if a solution was found by the forward condition
-      if(fc_finished && (fc_solution != 0) && (fc_solution != max_k_step))
-      {
-        // We should only present the result if the base case finished
-        // and haven't crashed (if it crashed, bc_solution will be UINT_MAX
-        if(bc_finished && (bc_solution != max_k_step))
-        {
-          std::cout << std::endl << "Solution found by the forward condition; "
-              << "all states are reachable (k = " << fc_solution
-              << ")" << std::endl;
-          std::cout << "VERIFICATION SUCCESSFUL" << std::endl;
-          return false;
-        }
-      }
+    // Stop the workers whose answer can no longer make a difference
+    for(unsigned int w = 0; w < jobs; ++w)
+    {
+      uint64_t k = workers[w].k;
+      if(workers[w].pid == 0 || k == 0 || workers[w].cancelled)
+        continue;
 
-      // Check if a solution was found by the inductive step
-      if(is_finished && (is_solution != 0) && (is_solution != max_k_step))
+      if(kind_dominated(board, workers[w].type, k))
       {
-        // We should only present the result if the base case finished
-        // and haven't crashed (if it crashed, bc_solution will be UINT_MAX
-        if(bc_finished && (bc_solution != max_k_step))
-        {
-          std::cout << std::endl << "Solution found by the inductive step "
-              << "(k = " << is_solution << ")" << std::endl;
-          std::cout << "VERIFICATION SUCCESSFUL" << std::endl;
-          return false;
-        }
+        workers[w].cancelled = true;
+        kill(workers[w].pid, SIGKILL);
       }
-
-      // Couldn't find a bug or a proof for the current deepth
-      std::cout << std::endl << "VERIFICATION UNKNOWN" << std::endl;
-      return false;
-      break;
     }
+  }
 
-    case BASE_CASE:
-    {
-      // Set that we are running base case
-      opts.set_option("base-case", true);
-      opts.set_option("forward-condition", false);
-      opts.set_option("inductive-step", false);
-
-      // Start communication to the parent process
-      close(forward_pipe[0]);
-      close(backward_pipe[1]);
-
-      // Struct to keep the result
-      struct resultt r = { process_type, 0 };
-
-      // Run bmc and only send results in two occasions:
-      // 1. A bug was found, we send the step where it was found
-      // 2. It couldn't find a bug
-      for(u_int k_step = 1; k_step <= max_k_step; k_step += k_step_inc)
-      {
-        bmct bmc(goto_functions, opts, context, ui_message_handler);
-        set_verbosity_msg(bmc);
+  // Shut down whatever is still running
+  for(unsigned int w = 0; w < jobs; ++w)
+  {
+    if(workers[w].pid == 0)
+      continue;
 
-        bmc.options.set_option("unwind", i2string(k_step));
+    workers[w].cancelled = true;
+    kill(workers[w].pid, SIGKILL);
+    waitpid(workers[w].pid, nullptr, 0);
+  }
 
-        std::cout << std::endl << "*** K-Induction Loop Iteration ";
-        std::cout << i2string((unsigned long) k_step);
-        std::cout << " ***" << std::endl;
-        std::cout << "*** Checking base case" << std::endl;
+  sigaction(SIGCHLD, &old_sa, nullptr);
+  kind_board_sem = nullptr;
 
-        // If an exception was thrown, we should abort the process
-        bool res = true;
-        try {
-          res = do_bmc(bmc);
-        }
-        catch(...)
-        {
-          break;
-        }
+  uint64_t bug_k = board->bug_k;
+  uint64_t safe_k = board->safe_k;
+  uint64_t fc_k = board->proof_k[FORWARD_CONDITION];
+  uint64_t is_k = board->proof_k[INDUCTIVE_STEP];
 
-        // Send information to parent if no bug was found
-        if(res == smt_convt::P_SATISFIABLE)
-        {
-          r.k = k_step;
+  sem_destroy(&board->updated);
+  munmap(mem, board_size);
 
-          // Write result
-          u_int len = write(forward_pipe[1], &r, sizeof(r));
-          assert(len == sizeof(r) && "short write");
-          (void)len; //ndebug
+  // Check if a solution was found by the base case
+  if(bug_k != 0)
+  {
+    std::cout << std::endl << "Bug found by the base case (k = "
+        << bug_k << ")" << std::endl;
+    std::cout << "VERIFICATION FAILED" << std::endl;
+    return true;
+  }
 
-          std::cout << "BASE CASE PROCESS FINISHED." << std::endl;
+  // Proofs only count once the base case has shown that there is no bug up to
+  // the same bound
+  if(fc_k != 0 && safe_k >= fc_k)
+  {
+    std::cout << std::endl << "Solution found by the forward condition; "
+        << "all states are reachable (k = " << fc_k
+        << ")" << std::endl;
+    std::cout << "VERIFICATION SUCCESSFUL" << std::endl;
+    return false;
+  }
 
-          return 1;
-        }
+  if(is_k != 0 && safe_k >= is_k)
+  {
+    std::cout << std::endl << "Solution found by the inductive step "
+        << "(k = " << is_k << ")" << std::endl;
+    std::cout << "VERIFICATION SUCCESSFUL" << std::endl;
+    return false;
+  }
 
-        // Check if the parent process is asking questions
+  // Couldn't find a bug or a proof for the current deepth
+  std::cout << std::endl << "VERIFICATION UNKNOWN" << std::endl;
+  return false;
+}
 
-        // Perform read and interpret the number of bytes read
-        struct resultt a_result;
-        int read_size = read(backward_pipe[0], &a_result, sizeof(resultt));
-        if(read_size != sizeof(resultt))
-        {
-          if(read_size == 0)
-          {
-            // Client hung up; continue on, but don't interpret the result.
-            continue;
-          }
-          else if (read_size == -1 && errno == EAGAIN)
-          {
-            // No data available yet
-            continue;
-          }
-          else
-          {
-            // Invalid size read.
-            std::cerr << "Short read communicating with kinduction parent"
-                << std::endl;
-            std::cerr << "Size " << read_size << ", expected "
-                << sizeof(resultt) << std::endl;
-            abort();
-          }
-        }
+void cbmc_parseoptionst::run_k_induction_worker(
+  optionst &opts,
+  kind_boardt *board,
+  unsigned int slot,
+  u_int max_k_step)
+{
+  kind_workert &self = kind_board_workers(board)[slot];
+  PROCESS_TYPE type = self.type;
 
-        // We only receive messages from the parent
-        assert(a_result.type == PARENT);
+  // This will be changed to true if the code contains:
+  // 1. Dynamic allocated memory
+  // 2. Multithreaded code (during symbolic execution)
+  // 3. Recursion (during inlining)
+  if(type == INDUCTIVE_STEP)
+    opts.set_option("disable-inductive-step", false);
 
-        // If the value being asked is greater or equal the current step,
-        // then we can stop the base case. It can be equal, because we
-        // have just checked the current value of k
+  while(true)
+  {
+    if(type == FORWARD_CONDITION
+       && opts.get_bool_option("disable-forward-condition"))
+      break;
 
-        if(a_result.k >= k_step)
-          break;
-        else
-        {
-          // Otherwise, we just need to check the base case for k = a_result.k
-          k_step = max_k_step = a_result.k;
-        }
-      }
+    if(type == INDUCTIVE_STEP
+       && opts.get_bool_option("disable-inductive-step"))
+      break;
 
-      // Send information to parent that a bug was not found
-      r.k = 0;
+    // Take the next k for this strategy; workers of the same strategy are
+    // thus strided over the k values.
+    uint64_t k = __sync_fetch_and_add(&board->next_k[type], board->k_step_inc);
+    if(k > max_k_step || board->bug_k != 0 || kind_dominated(board, type, k))
+      break;
 
-      u_int len = write(forward_pipe[1], &r, sizeof(r));
-      assert(len == sizeof(r) && "short write");
-      (void)len; //ndebug
+    self.k = k;
+    __sync_synchronize();
 
-      std::cout << "BASE CASE PROCESS FINISHED." << std::endl;
-      break;
-    }
+    std::cout << std::endl << "*** K-Induction Loop Iteration ";
+    std::cout << k;
+    std::cout << " ***" << std::endl;
+    std::cout << "*** Checking " << kind_type_name(type) << std::endl;
 
-    case FORWARD_CONDITION:
+    bool done = false;
+    try
     {
-      // Set that we are running forward condition
-      opts.set_option("base-case", false);
-      opts.set_option("forward-condition", true);
-      opts.set_option("inductive-step", false);
-
-      // Start communication to the parent process
-      close(forward_pipe[0]);
-      close(backward_pipe[1]);
-
-      // Struct to keep the result
-      struct resultt r = { process_type, 0 };
-
-      // Run bmc and only send results in two occasions:
-      // 1. A proof was found, we send the step where it was found
-      // 2. It couldn't find a proof
-      for(u_int k_step = 2; k_step <= max_k_step; k_step += k_step_inc)
+      switch(type)
       {
-        if(opts.get_bool_option("disable-forward-condition"))
+        case BASE_CASE:
+          if(do_base_case(opts, goto_functions, k))
+          {
+            kind_board_min(&board->bug_k, k);
+            done = true;
+          }
+          else
+            kind_board_max(&board->safe_k, k);
           break;
 
-        bmct bmc(goto_functions, opts, context, ui_message_handler);
-        set_verbosity_msg(bmc);
-
-        bmc.options.set_option("unwind", i2string(k_step));
-
-        std::cout << std::endl << "*** K-Induction Loop Iteration ";
-        std::cout << i2string((unsigned long) k_step);
-        std::cout << " ***" << std::endl;
-        std::cout << "*** Checking forward condition" << std::endl;
-
-        // If an exception was thrown, we should abort the process
-        bool res = true;
-        try {
-          res = do_bmc(bmc);
-        }
-        catch(...)
-        {
+        case FORWARD_CONDITION:
+          if(!do_forward_condition(opts, goto_functions, k))
+          {
+            kind_board_min(&board->proof_k[type], k);
+            done = true;
+          }
           break;
-        }
-
-        // Send information to parent if no bug was found
-        if(res == smt_convt::P_UNSATISFIABLE)
-        {
-          r.k = k_step;
 
-          // Write result
-          u_int len = write(forward_pipe[1], &r, sizeof(r));
-          assert(len == sizeof(r) && "short write");
-          (void)len; //ndebug
-
-          std::cout << "FORWARD CONDITION PROCESS FINISHED." << std::endl;
+        case INDUCTIVE_STEP:
+          if(!do_inductive_step(opts, goto_functions, k))
+          {
+            kind_board_min(&board->proof_k[type], k);
+            done = true;
+          }
+          break;
 
-          return 0;
-        }
+        default:
+          assert(0 && "Unknown process type.");
       }
-
-      // Send information to parent that it couldn't prove the code
-      r.k = 0;
-
-      u_int len = write(forward_pipe[1], &r, sizeof(r));
-      assert(len == sizeof(r) && "short write");
-      (void)len; //ndebug
-
-      std::cout << "FORWARD CONDITION PROCESS FINISHED." << std::endl;
-      break;
     }
-
-    case INDUCTIVE_STEP:
+    catch(...)
     {
-      // Set that we are running inductive step
-      opts.set_option("base-case", false);
-      opts.set_option("forward-condition", false);
-      opts.set_option("inductive-step", true);
-
-      // This will be changed to true if the code contains:
-      // 1. Dynamic allocated memory
-      // 2. Multithreaded code (during symbolic execution)
-      // 3. Recursion (during inlining)
-      opts.set_option("disable-inductive-step", false);
-
-      // Start communication to the parent process
-      close(forward_pipe[0]);
-      close(backward_pipe[1]);
-
-      // Struct to keep the result
-      struct resultt r = { process_type, 0 };
-
-      // Run bmc and only send results in two occasions:
-      // 1. A proof was found, we send the step where it was found
-      // 2. It couldn't find a proof
-      for(u_int k_step = 2; k_step <= max_k_step; k_step += k_step_inc)
-      {
-        bmct bmc(goto_functions, opts, context, ui_message_handler);
-        set_verbosity_msg(bmc);
-
-        bmc.options.set_option("unwind", i2string(k_step));
-
-        std::cout << std::endl << "*** K-Induction Loop Iteration ";
-        std::cout << i2string((unsigned long) k_step+1);
-        std::cout << " ***" << std::endl;
-        std::cout << "*** Checking inductive step" << std::endl;
-
-        // If an exception was thrown, we should abort the process
-        bool res = true;
-        try {
-          res = do_bmc(bmc);
-        }
-        catch(...)
-        {
-          break;
-        }
-
-        // Send information to parent if no bug was found
-        if(res == smt_convt::P_UNSATISFIABLE)
-        {
-          r.k = k_step;
-
-          // Write result
-          u_int len = write(forward_pipe[1], &r, sizeof(r));
-          assert(len == sizeof(r) && "short write");
-          (void)len; //ndebug
-
-          std::cout << "INDUCTIVE STEP PROCESS FINISHED." << std::endl;
-
-          return res;
-        }
-      }
-
-      // Send information to parent that it couldn't prove the code
-      r.k = 0;
+      // If an exception was thrown, we should stop this worker
+      done = true;
+    }
 
-      u_int len = write(forward_pipe[1], &r, sizeof(r));
-      assert(len == sizeof(r) && "short write");
-      (void)len; //ndebug
+    self.k = 0;
+    sem_post(&board->updated);
 
-      std::cout << "INDUCTIVE STEP PROCESS FINISHED." << std::endl;
+    if(done)
       break;
-    }
-
-    default:
-      assert(0 && "Unknown process type.");
   }
 
-  return 0;
+  std::cout << kind_type_name(type) << " worker finished." << std::endl;
 }
 
 int cbmc_parseoptionst::doit_k_induction()
@@ -1132,9 +1009,16 @@ int cbmc_parseoptionst::do_base_case(
   opts.set_option("forward-condition", false);
   opts.set_option("inductive-step", false);
 
-  bmct bmc(goto_functions, opts, context, ui_message_handler);
-  set_verbosity_msg(bmc);
+  // An incremental base case keeps its bmct, and thus its solver, across k
+  // steps
+  if(!base_case_bmc || !opts.get_bool_option("incremental-base-case"))
+  {
+    base_case_bmc.reset(
+      new bmct(goto_functions, opts, context, ui_message_handler));
+    set_verbosity_msg(*base_case_bmc);
+  }
 
+  bmct &bmc = *base_case_bmc;
   bmc.options.set_option("unwind", integer2string(k_step));
 
   switch(do_bmc(bmc))
@@ -1659,9 +1543,9 @@ void cbmc_parseoptionst::print_ileave_points(namespacet &ns,
 bool cbmc_parseoptionst::read_goto_binary(
   goto_functionst &goto_functions)
 {
-  std::ifstream in(cmdline.getval("binary"), std::ios::binary);
-
-  if(!in)
+  if(::read_goto_binary(
+       cmdline.getval("binary"), context, goto_functions,
+       *get_message_handler()))
   {
     error(
       std::string("Failed to open `")+
@@ -1670,9 +1554,6 @@ bool cbmc_parseoptionst::read_goto_binary(
     return true;
   }
 
-  ::read_goto_binary(
-    in, context, goto_functions, *get_message_handler());
-
   return false;
 }
 
@@ -1720,6 +1601,16 @@ bool cbmc_parseoptionst::process_goto_program(
 
     goto_check(ns, options, goto_functions);
 
+    if(cmdline.isset("interval-analysis"))
+    {
+      unsigned int total;
+      unsigned int discharged = discharge_claims(ns, goto_functions, total);
+      std::ostringstream str;
+      str << "Interval analysis discharged " << discharged << " of " << total
+          << " claims";
+      status(str.str());
+    }
+
     // show it?
     if(cmdline.isset("show-goto-value-sets"))
     {
@@ -1902,6 +1793,7 @@ void cbmc_parseoptionst::help()
     " --preprocess                 stop after preprocessing\n"
     " --no-inlining                disable inlining function calls\n"
     " --full-inlining              perform full inlining of function calls\n"
+    " --goto-convert-jobs nr       convert functions to goto programs in nr worker processes\n"
     " --all-claims                 keep all claims\n"
     " --show-loops                 show the loops in the program\n"
     " --show-claims                only show claims\n"
@@ -1947,6 +1839,11 @@ void cbmc_parseoptionst::help()
     " --unroll-loops               unwind all loops by the value defined by the --unwind option\n"
     " --no-slice                   do not remove unused equations\n"
     " --extended-try-analysis      check all the try block, even when an exception is thrown\n"
+    " --multi-property             solve each claim separately, reporting each result as\n"
+    "                              soon as it is known; the program is encoded once when\n"
+    "                              the solver supports contexts\n"
+    " --jobs nr                    number of worker processes for parallel modes\n"
+    "                              (default is the number of online processors)\n"
 
     "\nIncremental BMC\n"
     " --falsification              incremental loop unwinding for bug searching\n"
@@ -1965,10 +1862,16 @@ void cbmc_parseoptionst::help()
     " --bv                         use solver with bit-vector arithmetic\n"
     " --ir                         use solver with integer/real arithmetic\n"
     " --smtlib                     use SMT lib format\n"
-    " --smtlib-solver-prog         SMT lib program name\n"
+    " --smtlib-solver-prog         SMT lib program name; several, separated by\n"
+    "                              commas, are raced on the same formula\n"
     " --output <filename>          output VCCs in SMT lib format to given file\n"
     " --fixedbv                    encode floating-point as fixed bitvectors (default)\n"
     " --floatbv                    encode floating-point using the SMT floating-point theory\n"
+    " --formula-cache <dir>        reuse solver verdicts stored in dir for identical formulas\n"
+    " --portfolio                  race every available solver on the formula and take the\n"
+    "                              first verdict\n"
+    " --portfolio-int-encoding     with --portfolio, also race each solver under the\n"
+    "                              other arithmetic encoding\n"
 
     "\nIncremental SMT solving\n"
     " --smt-during-symex           enable incremental SMT solving (experimental)\n"
@@ -1984,6 +1887,8 @@ void cbmc_parseoptionst::help()
     " --memory-leak-check          enable memory leak check check\n"
     " --nan-check                  check floating-point for NaN\n"
     " --overflow-check             enable arithmetic over- and underflow check\n"
+    " --interval-analysis          remove the bounds, division by zero and overflow\n"
+    "                              claims that an interval analysis proves safe\n"
     " --deadlock-check             enable global and local deadlock check with mutex\n"
     " --data-races-check           enable data races check\n"
     " --lock-order-check           enable for lock acquisition ordering check\n"
@@ -1996,13 +1901,16 @@ void cbmc_parseoptionst::help()
     " --forward-condition          check the forward condition\n"
     " --inductive-step             check the inductive step\n"
     " --k-induction                prove by k-induction \n"
-    " --k-induction-parallel       prove by k-induction, running each step on a separate\n"
-    "                              process\n"
+    " --k-induction-parallel       prove by k-induction, running the steps on --jobs separate\n"
+    "                              processes (at least one per step)\n"
     " --constrain-all-states       remove all redundant states in the inductive step\n"
     " --k-step nr                  set k increment (default is 1)\n"
     " --max-k-step nr              set max number of iteration (default is 50)\n"
     " --unlimited-k-steps          set max number of iteration to UINT_MAX\n"
     " --show-counter-example       print the counter-example produced by the inductive step\n"
+    " --incremental-base-case      keep one solver context alive across the base case k steps,\n"
+    "                              reusing the encoding of the shared prefix (needs z3,\n"
+    "                              yices, mathsat or smtlib)\n"
 
     "\nScheduling approaches\n"
     " --schedule                   use schedule recording approach \n"
@@ -2013,15 +1921,20 @@ void cbmc_parseoptionst::help()
     "\nConcurrency checking\n"
     " --context-bound nr           limit number of context switches for each thread \n"
     " --state-hashing              enable state-hashing, prunes duplicate states\n"
+    " --state-hash-spill <file>    bound the state hash table, moving older hashes to file\n"
     " --control-flow-test          enable context switch before control flow tests\n"
     " --no-por                     do not do partial order reduction\n"
     " --all-runs                   check all interleavings, even if a bug was already found\n"
+    " --parallel-interleavings     explore interleavings with --jobs worker processes\n"
 
     "\nMiscellaneous options\n"
     " --memlimit                   configure memory limit, of form \"100m\" or \"2g\"\n"
     " --timeout                    configure time limit, integer followed by {s,m,h}\n"
     " --memstats                   print memory usage statistics\n"
+    " --merge-stats                print the phi assignments made and time spent at each\n"
+    "                              point where paths merge\n"
     " --no-simplify                do not simplify any expression\n"
+    " --hash-consing               share one node between structurally equal expressions\n"
     " --enable-core-dump           do not disable core dump output\n"
     "\n";
 }
@@ -12,6 +12,7 @@ Author: Daniel Kroening, kroening@kroening.com
 #include <esbmc/bmc.h>
 #include <goto-programs/goto_convert_functions.h>
 #include <langapi/language_ui.h>
+#include <memory>
 #include <util/cmdline.h>
 #include <util/options.h>
 #include <util/parseoptions.h>
@@ -19,6 +20,8 @@ Author: Daniel Kroening, kroening@kroening.com
 
 extern const struct opt_templ esbmc_options[];
 
+struct kind_boardt;
+
 class cbmc_parseoptionst:
   public parseoptions_baset,
   public language_uit
@@ -47,6 +50,11 @@ protected:
 
   int doit_k_induction();
   int doit_k_induction_parallel();
+  void run_k_induction_worker(
+    optionst &opts,
+    kind_boardt *board,
+    unsigned int slot,
+    u_int max_k_step);
 
   int doit_falsification();
   int doit_incremental();
@@ -74,6 +82,10 @@ protected:
 
 public:
   goto_functionst goto_functions;
+
+protected:
+  // Base case checker kept across k steps with --incremental-base-case
+  std::unique_ptr<bmct> base_case_bmc;
 };
 
 #endif
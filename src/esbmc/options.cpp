@@ -42,6 +42,7 @@ const struct opt_templ esbmc_options[] = {
   { 0, "preprocess", switc, "" },
   { 0, "no-inlining", switc, "" },
   { 0, "full-inlining", switc, "" },
+  { 0, "goto-convert-jobs", number, "" },
   { 0, "all-claims", switc, "" },
   { 0, "show-loops", switc, "" },
   { 0, "show-claims", switc, "" },
@@ -78,6 +79,8 @@ const struct opt_templ esbmc_options[] = {
   { 0, "no-slice", switc, "" },
   { 0, "extended-try-analysis", switc, "" },
   { 0, "skip-bmc", switc, "" },
+  { 0, "multi-property", switc, "" },
+  { 0, "jobs", number, "" },
 
   // IBMC
   { 0, "incremental-bmc", switc, "" },
@@ -97,6 +100,9 @@ const struct opt_templ esbmc_options[] = {
   { 0, "output", string, "" },
   { 0, "floatbv", switc, "" },
   { 0, "fixedbv", switc, "" },
+  { 0, "formula-cache", string, "" },
+  { 0, "portfolio", switc, "" },
+  { 0, "portfolio-int-encoding", switc, "" },
 
   // Incremental SMT
   { 0, "smt-during-symex", switc, "" },
@@ -112,6 +118,7 @@ const struct opt_templ esbmc_options[] = {
   { 0, "nan-check", switc, "" },
   { 0, "memory-leak-check", switc, "" },
   { 0, "overflow-check", switc, "" },
+  { 0, "interval-analysis", switc, "" },
   { 0, "deadlock-check", switc, "" },
   { 0, "data-races-check", switc, "" },
   { 0, "lock-order-check", switc, "" },
@@ -130,6 +137,7 @@ const struct opt_templ esbmc_options[] = {
   { 0, "max-k-step", number, "50" },
   { 0, "unlimited-k-steps", switc, "" },
   { 0, "show-counter-example", switc, "" },
+  { 0, "incremental-base-case", switc, "" },
 
   // Scheduling
   { 0, "schedule", switc, "" },
@@ -139,15 +147,19 @@ const struct opt_templ esbmc_options[] = {
   // Concurrency checking
   { 0, "context-bound", number, "-1" },
   { 0, "state-hashing", switc, "" },
+  { 0, "state-hash-spill", string, "" },
   { 0, "no-por", switc, "" },
   { 0, "all-runs", switc, "" },
+  { 0, "parallel-interleavings", switc, "" },
 
   // Miscellaneous
   { 0, "memlimit", string, "" },
   { 0, "memstats", switc, "" },
+  { 0, "merge-stats", switc, "" },
   { 0, "timeout", string, "" },
   { 0, "enable-core-dump", switc, "" },
   { 0, "no-simplify", switc, "" },
+  { 0, "hash-consing", switc, "" },
 
   // DEBUG options
 
@@ -9,17 +9,31 @@ Date: June 2003
 \*******************************************************************/
 
 #include <cassert>
+#include <cstdlib>
 #include <goto-programs/goto_convert_functions.h>
+#include <goto-programs/goto_function_serialization.h>
 #include <goto-programs/goto_inline.h>
+#include <goto-programs/goto_program_irep.h>
 #include <goto-programs/remove_skip.h>
+#include <iostream>
+#include <sstream>
 #include <util/base_type.h>
 #include <util/c_types.h>
 #include <util/i2string.h>
+#include <util/irep_serialization.h>
 #include <util/prefix.h>
 #include <util/std_code.h>
 #include <util/std_expr.h>
+#include <util/symbol_serialization.h>
 #include <util/type_byte_size.h>
 
+#ifndef _WIN32
+#include <cerrno>
+#include <cstdio>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
 goto_convert_functionst::goto_convert_functionst(
   contextt &_context,
   optionst &_options,
@@ -47,6 +61,13 @@ void goto_convert_functionst::goto_convert()
     }
   );
 
+  unsigned int jobs = atoi(options.get_option("goto-convert-jobs").c_str());
+
+#ifndef _WIN32
+  if(jobs > 1 && symbol_list.size() > jobs)
+    convert_functions_parallel(symbol_list, jobs);
+  else
+#endif
   for(auto & it : symbol_list)
   {
     convert_function(*it);
@@ -55,6 +76,260 @@ void goto_convert_functionst::goto_convert()
   functions.compute_location_numbers();
 }
 
+#ifndef _WIN32
+void goto_convert_functionst::convert_functions_parallel(
+  const symbol_listt &symbol_list,
+  unsigned int jobs)
+{
+  // Each worker converts a contiguous slice of the functions in a forked
+  // copy of this process, then sends back their goto programs along with
+  // any symbols (temporaries, mostly) that conversion added or rewrote
+  // (VLA declarations change the type of their symbol). Slices are
+  // read back in order, so the context ends up just as a serial conversion
+  // would have left it. Nothing here is thread safe, hence processes.
+  unsigned int num_symbols = context.size();
+  std::vector<std::pair<pid_t, int> > workers;
+
+  // Don't let the workers inherit (and so repeat) buffered output
+  std::cout.flush();
+  fflush(stdout);
+
+  // If a worker can't be started, the functions from its slice onwards are
+  // converted here once the workers already started are done
+  symbol_listt::const_iterator serial_from = symbol_list.end();
+
+  symbol_listt::const_iterator it = symbol_list.begin();
+  for(unsigned int w = 0; w < jobs; w++)
+  {
+    symbol_listt::const_iterator slice_begin = it;
+    symbol_listt slice;
+    size_t end = symbol_list.size() * (w + 1) / jobs;
+    for(size_t i = symbol_list.size() * w / jobs; i < end; i++)
+      slice.push_back(*it++);
+
+    int fds[2];
+    if(pipe(fds) != 0)
+    {
+      perror("Couldn't create pipe for goto conversion worker");
+      serial_from = slice_begin;
+      break;
+    }
+
+    pid_t pid = fork();
+    if(pid < 0)
+    {
+      perror("Couldn't fork goto conversion worker");
+      close(fds[0]);
+      close(fds[1]);
+      serial_from = slice_begin;
+      break;
+    }
+
+    if(pid == 0)
+    {
+      close(fds[0]);
+      int status = convert_functions_worker(slice, num_symbols, fds[1]);
+      std::cout.flush();
+      _exit(status);
+    }
+
+    close(fds[1]);
+    workers.emplace_back(pid, fds[0]);
+  }
+
+  bool failed = false;
+  for(auto const &worker : workers)
+  {
+    std::string data;
+    char buf[65536];
+    for(;;)
+    {
+      ssize_t len = read(worker.second, buf, sizeof(buf));
+      if(len < 0 && errno == EINTR)
+        continue;
+      if(len <= 0)
+        break;
+      data.append(buf, len);
+    }
+    close(worker.second);
+
+    // Conversion errors have already been reported by the worker
+    int status;
+    waitpid(worker.first, &status, 0);
+    if(!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+      failed = true;
+
+    if(!failed)
+      read_converted_functions(data);
+  }
+
+  if(failed)
+    throw 0;
+
+  for(; serial_from != symbol_list.end(); serial_from++)
+    convert_function(**serial_from);
+}
+
+int goto_convert_functionst::convert_functions_worker(
+  const symbol_listt &slice,
+  unsigned int num_symbols,
+  int fd)
+{
+  // Remember what the existing symbols looked like, to find the ones that
+  // conversion rewrites in place. Ireps are shared, so this is cheap, and
+  // symbols left alone compare equal without being walked.
+  std::vector<std::pair<typet, exprt> > before;
+  before.reserve(num_symbols);
+  context.foreach_operand_in_order(
+    [&before] (const symbolt &s)
+    {
+      before.emplace_back(s.type, s.value);
+    }
+  );
+
+  try
+  {
+    for(auto const &it : slice)
+      convert_function(*it);
+  }
+
+  catch(int)
+  {
+    error();
+  }
+
+  catch(const char *e)
+  {
+    error(e);
+  }
+
+  catch(const std::string &e)
+  {
+    error(e);
+  }
+
+  if(get_error_found())
+    return 1;
+
+  std::ostringstream out;
+  irep_serializationt::ireps_containert ic;
+  symbol_serializationt symbolconverter(ic);
+  goto_function_serializationt gfconverter(ic);
+
+  // Symbols are kept in order of addition, so anything new is at the end
+  std::vector<const symbolt *> changed_symbols, new_symbols;
+  unsigned int idx = 0;
+  context.foreach_operand_in_order(
+    [&changed_symbols, &new_symbols, &before, &idx, num_symbols]
+    (const symbolt &s)
+    {
+      if(idx >= num_symbols)
+        new_symbols.push_back(&s);
+      else if(s.type != before[idx].first || s.value != before[idx].second)
+        changed_symbols.push_back(&s);
+      idx++;
+    }
+  );
+
+  write_long(out, changed_symbols.size());
+  for(auto const &s : changed_symbols)
+    symbolconverter.convert(*s, out);
+
+  write_long(out, new_symbols.size());
+  for(auto const &s : new_symbols)
+    symbolconverter.convert(*s, out);
+
+  std::vector<goto_functionst::function_mapt::iterator> converted;
+  for(auto const &it : slice)
+  {
+    goto_functionst::function_mapt::iterator f_it =
+      functions.function_map.find(it->name);
+    if(f_it != functions.function_map.end())
+      converted.push_back(f_it);
+  }
+
+  write_long(out, converted.size());
+  for(auto &f_it : converted)
+  {
+    goto_functiont &f = f_it->second;
+    write_string(out, f_it->first.as_string());
+    write_long(out, f.body_available);
+    write_long(out, f.is_inlined());
+    if(f.body_available)
+    {
+      f.body.compute_location_numbers();
+      gfconverter.convert(f, out);
+    }
+  }
+
+  const std::string data = out.str();
+  size_t done = 0;
+  while(done < data.size())
+  {
+    ssize_t len = write(fd, data.data() + done, data.size() - done);
+    if(len < 0 && errno == EINTR)
+      continue;
+    if(len <= 0)
+      return 1;
+    done += len;
+  }
+
+  return 0;
+}
+
+void goto_convert_functionst::read_converted_functions(const std::string &data)
+{
+  std::istringstream in(data);
+  irep_serializationt::ireps_containert ic;
+  irep_serializationt irepconverter(ic);
+  symbol_serializationt symbolconverter(ic);
+  goto_function_serializationt gfconverter(ic);
+
+  unsigned int count = irepconverter.read_long(in);
+  for(unsigned int i = 0; i < count; i++)
+  {
+    irept t;
+    symbolconverter.convert(in, t);
+    symbolt symbol;
+    symbol.from_irep(t);
+
+    symbolt *s = context.find_symbol(symbol.name);
+    assert(s != nullptr);
+    s->swap(symbol);
+  }
+
+  count = irepconverter.read_long(in);
+  for(unsigned int i = 0; i < count; i++)
+  {
+    irept t;
+    symbolconverter.convert(in, t);
+    symbolt symbol;
+    symbol.from_irep(t);
+    context.add(symbol);
+  }
+
+  count = irepconverter.read_long(in);
+  for(unsigned int i = 0; i < count; i++)
+  {
+    irep_idt identifier = irepconverter.read_string(in);
+    const symbolt *symbol = context.find_symbol(identifier);
+    assert(symbol != nullptr);
+
+    goto_functiont &f = functions.function_map[identifier];
+    f.type = to_code_type(symbol->type);
+    f.body_available = irepconverter.read_long(in);
+    f.set_inlined(irepconverter.read_long(in));
+
+    if(f.body_available)
+    {
+      irept t;
+      gfconverter.convert(in, t);
+      ::convert(t, f.body);
+    }
+  }
+}
+#endif
+
 bool goto_convert_functionst::hide(const goto_programt &goto_program)
 {
   for(const auto & instruction : goto_program.instructions)
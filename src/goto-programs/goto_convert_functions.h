@@ -58,6 +58,17 @@ protected:
 
   static bool hide(const goto_programt &goto_program);
 
+  // --goto-convert-jobs: convert slices of the functions in worker
+  // processes, each writing its results back to the parent through fd.
+  void convert_functions_parallel(
+    const symbol_listt &symbol_list,
+    unsigned int jobs);
+  int convert_functions_worker(
+    const symbol_listt &slice,
+    unsigned int num_symbols,
+    int fd);
+  void read_converted_functions(const std::string &data);
+
   //
   // function calls
   //
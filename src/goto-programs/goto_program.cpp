@@ -314,6 +314,40 @@ void goto_programt::update()
 {
   compute_target_numbers();
   compute_location_numbers();
+  flat_instructions.clear();
+}
+
+void goto_programt::build_flat() const
+{
+  flat_instructions.clear();
+  flat_instructions.reserve(instructions.size());
+
+  if(instructions.empty())
+    return;
+
+  unsigned base = instructions.front().location_number;
+
+  for(const_targett it = instructions.begin(); it != instructions.end(); it++)
+  {
+    // flat_index relies on location numbers being consecutive
+    assert(it->location_number - base == flat_instructions.size());
+
+    flat_instructiont f;
+    f.it = it;
+    f.type = it->type;
+    f.loop_number = it->loop_number;
+    f.target = instructions.size();
+    f.backwards = false;
+
+    if(it->is_goto() && it->targets.size() == 1)
+    {
+      const_targett target = it->targets.front();
+      f.target = target->location_number - base;
+      f.backwards = target->location_number <= it->location_number;
+    }
+
+    flat_instructions.push_back(f);
+  }
 }
 
 std::ostream& goto_programt::output(
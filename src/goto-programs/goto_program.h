@@ -14,6 +14,7 @@ Author: Daniel Kroening, kroening@kroening.com
 #include <cassert>
 #include <ostream>
 #include <set>
+#include <vector>
 #include <util/irep2_utils.h>
 #include <util/location.h>
 #include <util/namespace.h>
@@ -279,6 +280,52 @@ public:
   //! The list of instructions in the goto program
   instructionst instructions;
 
+  /*! \brief Contiguous summary of one instruction, as used by symex
+  */
+  class flat_instructiont
+  {
+  public:
+    //! the instruction itself
+    const_targett it;
+
+    //! copied from the instruction
+    goto_program_instruction_typet type;
+    unsigned loop_number;
+
+    //! index of the single goto target, or the number of instructions
+    //! if there is none
+    unsigned target;
+
+    //! whether this is a backwards goto
+    bool backwards;
+  };
+
+  typedef std::vector<flat_instructiont> flat_instructionst;
+
+  //! Frozen view of the instructions, indexed by position. Built on first
+  //! use, which is expected to be after all passes ran, and dropped by
+  //! update(); don't hold on to it across changes to the program.
+  const flat_instructionst &flat() const
+  {
+    if(flat_instructions.size() != instructions.size())
+      build_flat();
+    return flat_instructions;
+  }
+
+  //! Position of an instruction in flat()
+  unsigned flat_index(const_targett target) const
+  {
+    const flat_instructionst &f = flat();
+    unsigned idx = target->location_number - f.front().it->location_number;
+    assert(idx < f.size() && f[idx].it == target);
+    return idx;
+  }
+
+  const flat_instructiont &flat_instruction(const_targett target) const
+  {
+    return flat()[flat_index(target)];
+  }
+
   void get_successors(
     targett target,
     targetst &successors);
@@ -410,12 +457,15 @@ public:
   {
     program.instructions.swap(instructions);
     program.local_variables.swap(local_variables);
+    program.flat_instructions.clear();
+    flat_instructions.clear();
   }
 
   //! Clear the goto program
   inline void clear()
   {
     instructions.clear();
+    flat_instructions.clear();
   }
 
   //! Copy a full goto program, preserving targets
@@ -440,6 +490,30 @@ public:
                               unsigned int len, FetchElem fetchelem,
                               ElemToInsn elemtoinsn, GetAttr getattr,
                               IsAttrNil isattrnil);
+
+protected:
+  //! The view holds iterators into the program it was built from, so a
+  //! copied program starts without one.
+  class flat_cachet : public flat_instructionst
+  {
+  public:
+    flat_cachet() = default;
+
+    flat_cachet(const flat_cachet &)
+      : flat_instructionst()
+    {
+    }
+
+    flat_cachet &operator=(const flat_cachet &)
+    {
+      clear();
+      return *this;
+    }
+  };
+
+  mutable flat_cachet flat_instructions;
+
+  void build_flat() const;
 };
 
 bool operator<(const goto_programt::const_targett i1,
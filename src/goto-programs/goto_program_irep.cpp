@@ -9,6 +9,7 @@
 
 #include <goto-programs/goto_program_irep.h>
 #include <util/i2string.h>
+#include <vector>
 
 void convert(const goto_programt::instructiont &instruction, irept &irep)
 {
@@ -113,6 +114,14 @@ void convert(const irept &irep, goto_programt &program)
 
   program.compute_location_numbers();
 
+  // Location numbers were just assigned from zero, so they index this
+  std::vector<goto_programt::targett> by_number;
+  by_number.reserve(program.instructions.size());
+  for(goto_programt::targett fit = program.instructions.begin();
+      fit != program.instructions.end();
+      fit++)
+    by_number.push_back(fit);
+
   // resolve targets
   std::list<std::list<unsigned>>::iterator nit = number_targets_list.begin();
   for(goto_programt::instructionst::iterator lit = program.instructions.begin();
@@ -121,17 +130,9 @@ void convert(const irept &irep, goto_programt &program)
   {
     for (unsigned int & tit : *nit)
     {
-      goto_programt::targett fit = program.instructions.begin();
-      for(; fit != program.instructions.end(); fit++)
-      {
-        if(fit->location_number == tit)
-        {
-          lit->targets.push_back(fit);
-          break;
-        }
-      }
-
-      if(fit == program.instructions.end())
+      if(tit < by_number.size())
+        lit->targets.push_back(by_number[tit]);
+      else
       {
         std::cout << "Warning: could not resolve target link "
             << "during irep->goto_program translation." << std::endl;
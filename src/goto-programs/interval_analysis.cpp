@@ -0,0 +1,798 @@
+/*******************************************************************\
+
+Module: Interval Analysis
+
+\*******************************************************************/
+
+#include <cassert>
+#include <goto-programs/interval_analysis.h>
+#include <set>
+#include <util/arith_tools.h>
+#include <util/irep2_utils.h>
+
+// Widen a join point once it has changed this many times; loops then need
+// only a few iterations to stabilise, rather than one per value.
+#define INTERVAL_WIDEN_AFTER 3
+
+static bool type_range(const type2tc &type, intervalt &range)
+{
+  if(!is_bv_type(type))
+    return false;
+
+  unsigned int width = type->get_width();
+  if(is_unsignedbv_type(type))
+  {
+    range.lower = 0;
+    range.upper = power(2, width) - 1;
+  }
+  else
+  {
+    range.upper = power(2, width - 1) - 1;
+    range.lower = -range.upper - 1;
+  }
+
+  return true;
+}
+
+static intervalt meet(const intervalt &a, const intervalt &b)
+{
+  intervalt res;
+  res.lower = a.lower > b.lower ? a.lower : b.lower;
+  res.upper = a.upper < b.upper ? a.upper : b.upper;
+  return res;
+}
+
+static intervalt join(const intervalt &a, const intervalt &b)
+{
+  intervalt res;
+  res.lower = a.lower < b.lower ? a.lower : b.lower;
+  res.upper = a.upper > b.upper ? a.upper : b.upper;
+  return res;
+}
+
+// Exact result of a binary operation, ignoring the width of its type.
+static bool arith(
+  const expr2tc &expr,
+  const intervalt &a,
+  const intervalt &b,
+  intervalt &res)
+{
+  if(is_add2t(expr))
+  {
+    res.lower = a.lower + b.lower;
+    res.upper = a.upper + b.upper;
+  }
+  else if(is_sub2t(expr))
+  {
+    res.lower = a.lower - b.upper;
+    res.upper = a.upper - b.lower;
+  }
+  else if(is_mul2t(expr))
+  {
+    mp_integer p[4] = {
+      a.lower * b.lower, a.lower * b.upper, a.upper * b.lower, a.upper * b.upper};
+    res.lower = res.upper = p[0];
+    for(const mp_integer &v : p)
+    {
+      if(v < res.lower)
+        res.lower = v;
+      if(v > res.upper)
+        res.upper = v;
+    }
+  }
+  else if(is_div2t(expr))
+  {
+    // Only non-negative operands, where truncation is plain rounding down
+    if(a.lower < 0 || b.lower <= 0)
+      return false;
+    res.lower = a.lower / b.upper;
+    res.upper = a.upper / b.lower;
+  }
+  else if(is_modulus2t(expr))
+  {
+    if(b.lower <= 0 && b.upper >= 0)
+      return false;
+    // |a % b| < |b|, and the result takes the sign of a
+    mp_integer m = (b.upper < 0 ? -b.lower : b.upper) - 1;
+    res.lower = a.lower < 0 ? -m : mp_integer(0);
+    res.upper = a.upper > 0 ? m : mp_integer(0);
+    if(a.lower >= 0 && a.upper < res.upper)
+      res.upper = a.upper;
+  }
+  else if(is_bitand2t(expr))
+  {
+    // Masking with a non-negative value can only clear bits
+    if(a.lower < 0 && b.lower < 0)
+      return false;
+    res.lower = 0;
+    res.upper = a.lower < 0 ? b.upper : b.lower < 0 ? a.upper
+              : a.upper < b.upper ? a.upper : b.upper;
+  }
+  else
+    return false;
+
+  return true;
+}
+
+static bool binary_operands(
+  const expr2tc &expr,
+  expr2tc &side_1,
+  expr2tc &side_2)
+{
+  if(is_add2t(expr))
+  {
+    side_1 = to_add2t(expr).side_1;
+    side_2 = to_add2t(expr).side_2;
+  }
+  else if(is_sub2t(expr))
+  {
+    side_1 = to_sub2t(expr).side_1;
+    side_2 = to_sub2t(expr).side_2;
+  }
+  else if(is_mul2t(expr))
+  {
+    side_1 = to_mul2t(expr).side_1;
+    side_2 = to_mul2t(expr).side_2;
+  }
+  else if(is_div2t(expr))
+  {
+    side_1 = to_div2t(expr).side_1;
+    side_2 = to_div2t(expr).side_2;
+  }
+  else if(is_modulus2t(expr))
+  {
+    side_1 = to_modulus2t(expr).side_1;
+    side_2 = to_modulus2t(expr).side_2;
+  }
+  else if(is_bitand2t(expr))
+  {
+    side_1 = to_bitand2t(expr).side_1;
+    side_2 = to_bitand2t(expr).side_2;
+  }
+  else
+    return false;
+
+  return true;
+}
+
+void interval_domaint::initialize(
+  const namespacet &ns __attribute__((unused)),
+  locationt l __attribute__((unused)))
+{
+  reachable = false;
+  values.clear();
+  changes = 0;
+}
+
+void interval_domaint::output(
+  const namespacet &ns __attribute__((unused)),
+  std::ostream &out) const
+{
+  if(!reachable)
+  {
+    out << "UNREACHABLE" << std::endl;
+    return;
+  }
+
+  for(const auto &it : values)
+    out << it.first << " in [" << it.second.lower << ", " << it.second.upper
+        << "]" << std::endl;
+}
+
+bool interval_domaint::merge(
+  const interval_domaint &b,
+  bool keepnew __attribute__((unused)))
+{
+  if(!join_with(b, changes >= INTERVAL_WIDEN_AFTER))
+    return false;
+
+  changes++;
+  return true;
+}
+
+bool interval_domaint::join_with(const interval_domaint &b, bool widen)
+{
+  if(!b.reachable)
+    return false;
+
+  if(!reachable)
+  {
+    reachable = true;
+    values = b.values;
+    return true;
+  }
+
+  bool changed = false;
+
+  for(auto it = values.begin(); it != values.end();)
+  {
+    auto b_it = b.values.find(it->first);
+    if(b_it == b.values.end())
+    {
+      // Top on the other side
+      it = values.erase(it);
+      changed = true;
+      continue;
+    }
+
+    intervalt j = join(it->second, b_it->second);
+    if(j != it->second)
+    {
+      if(widen)
+      {
+        const intervalt &range = tracked->find(it->first)->second;
+        if(j.lower < it->second.lower)
+          j.lower = range.lower;
+        if(j.upper > it->second.upper)
+          j.upper = range.upper;
+      }
+      it->second = j;
+      changed = true;
+    }
+    it++;
+  }
+
+  return changed;
+}
+
+bool interval_domaint::eval(const expr2tc &expr, intervalt &res) const
+{
+  intervalt range;
+  if(!type_range(expr->type, range))
+    return false;
+
+  res = range;
+
+  if(is_constant_int2t(expr))
+  {
+    intervalt c;
+    c.lower = c.upper = to_constant_int2t(expr).value;
+    if(range.contains(c))
+      res = c;
+  }
+  else if(is_symbol2t(expr))
+  {
+    auto it = values.find(to_symbol2t(expr).thename);
+    if(it != values.end())
+      res = it->second;
+  }
+  else if(is_typecast2t(expr))
+  {
+    intervalt from;
+    if(eval(to_typecast2t(expr).from, from) && range.contains(from))
+      res = from;
+  }
+  else if(is_neg2t(expr))
+  {
+    intervalt v, n;
+    if(eval(to_neg2t(expr).value, v))
+    {
+      n.lower = -v.upper;
+      n.upper = -v.lower;
+      if(range.contains(n))
+        res = n;
+    }
+  }
+  else if(is_if2t(expr))
+  {
+    const if2t &ifval = to_if2t(expr);
+    tvt c = eval_cond(ifval.cond);
+    intervalt t, f;
+    if(c.is_true())
+      eval(ifval.true_value, res);
+    else if(c.is_false())
+      eval(ifval.false_value, res);
+    else if(eval(ifval.true_value, t) && eval(ifval.false_value, f))
+      res = join(t, f);
+  }
+  else
+  {
+    expr2tc side_1, side_2;
+    intervalt a, b, r;
+    if(
+      binary_operands(expr, side_1, side_2) && eval(side_1, a) &&
+      eval(side_2, b) && arith(expr, a, b, r) && range.contains(r))
+      res = r;
+  }
+
+  return true;
+}
+
+tvt interval_domaint::eval_cond(const expr2tc &cond) const
+{
+  if(is_constant_bool2t(cond))
+    return tvt(to_constant_bool2t(cond).value);
+
+  if(is_not2t(cond))
+  {
+    tvt v = eval_cond(to_not2t(cond).value);
+    return v.invert();
+  }
+
+  if(is_and2t(cond))
+    return eval_cond(to_and2t(cond).side_1) &&
+           eval_cond(to_and2t(cond).side_2);
+
+  if(is_or2t(cond))
+    return eval_cond(to_or2t(cond).side_1) ||
+           eval_cond(to_or2t(cond).side_2);
+
+  if(is_implies2t(cond))
+  {
+    tvt premise = eval_cond(to_implies2t(cond).side_1);
+    return premise.invert() || eval_cond(to_implies2t(cond).side_2);
+  }
+
+  if(is_overflow2t(cond))
+  {
+    // No overflow if the exact result fits the type
+    const expr2tc &op = to_overflow2t(cond).operand;
+    expr2tc side_1, side_2;
+    intervalt range, a, b, r;
+    if(
+      type_range(op->type, range) && binary_operands(op, side_1, side_2) &&
+      eval(side_1, a) && eval(side_2, b) && arith(op, a, b, r) &&
+      range.contains(r))
+      return tvt(false);
+    return tvt(tvt::TV_UNKNOWN);
+  }
+
+  if(is_overflow_neg2t(cond))
+  {
+    const expr2tc &op = to_overflow_neg2t(cond).operand;
+    intervalt range, v;
+    if(type_range(op->type, range) && eval(op, v) && v.lower > range.lower)
+      return tvt(false);
+    return tvt(tvt::TV_UNKNOWN);
+  }
+
+  if(
+    !is_lessthan2t(cond) && !is_lessthanequal2t(cond) &&
+    !is_greaterthan2t(cond) && !is_greaterthanequal2t(cond) &&
+    !is_equality2t(cond) && !is_notequal2t(cond))
+    return tvt(tvt::TV_UNKNOWN);
+
+  const relation_data &rel = static_cast<const relation_data &>(*cond);
+  intervalt a, b;
+  if(!eval(rel.side_1, a) || !eval(rel.side_2, b))
+    return tvt(tvt::TV_UNKNOWN);
+
+  if(is_lessthan2t(cond))
+  {
+    if(a.upper < b.lower)
+      return tvt(true);
+    if(a.lower >= b.upper)
+      return tvt(false);
+  }
+  else if(is_lessthanequal2t(cond))
+  {
+    if(a.upper <= b.lower)
+      return tvt(true);
+    if(a.lower > b.upper)
+      return tvt(false);
+  }
+  else if(is_greaterthan2t(cond))
+  {
+    if(a.lower > b.upper)
+      return tvt(true);
+    if(a.upper <= b.lower)
+      return tvt(false);
+  }
+  else if(is_greaterthanequal2t(cond))
+  {
+    if(a.lower >= b.upper)
+      return tvt(true);
+    if(a.upper < b.lower)
+      return tvt(false);
+  }
+  else
+  {
+    tvt eq(tvt::TV_UNKNOWN);
+    if(a.is_singleton() && b.is_singleton() && a.lower == b.lower)
+      eq = tvt(true);
+    else if(meet(a, b).is_empty())
+      eq = tvt(false);
+    return is_equality2t(cond) ? eq : eq.invert();
+  }
+
+  return tvt(tvt::TV_UNKNOWN);
+}
+
+const intervalt *
+interval_domaint::tracked_range(const expr2tc &side, irep_idt &name) const
+{
+  expr2tc e = side;
+
+  // Look through casts that preserve every value
+  while(is_typecast2t(e))
+  {
+    intervalt to, from;
+    const expr2tc &src = to_typecast2t(e).from;
+    if(
+      !type_range(e->type, to) || !type_range(src->type, from) ||
+      !to.contains(from))
+      return nullptr;
+    e = src;
+  }
+
+  if(!is_symbol2t(e))
+    return nullptr;
+
+  name = to_symbol2t(e).thename;
+  auto it = tracked->find(name);
+  if(it == tracked->end())
+    return nullptr;
+
+  return &it->second;
+}
+
+void interval_domaint::refine(const expr2tc &side, const intervalt &bound)
+{
+  irep_idt name;
+  const intervalt *range = tracked_range(side, name);
+  if(range == nullptr)
+    return;
+
+  auto it = values.find(name);
+  intervalt r = meet(it == values.end() ? *range : it->second, bound);
+  if(r.is_empty())
+  {
+    reachable = false;
+    values.clear();
+    return;
+  }
+
+  values[name] = r;
+}
+
+void interval_domaint::refine_not_equal(
+  const expr2tc &side,
+  const mp_integer &value)
+{
+  irep_idt name;
+  const intervalt *range = tracked_range(side, name);
+  if(range == nullptr)
+    return;
+
+  auto it = values.find(name);
+  intervalt r = it == values.end() ? *range : it->second;
+  if(r.lower == value)
+    r.lower += 1;
+  else if(r.upper == value)
+    r.upper -= 1;
+  else
+    return;
+
+  if(r.is_empty())
+  {
+    reachable = false;
+    values.clear();
+    return;
+  }
+
+  values[name] = r;
+}
+
+void interval_domaint::assume_rel(const expr2tc &cond, bool polarity)
+{
+  const relation_data &rel = static_cast<const relation_data &>(*cond);
+  intervalt a, b;
+  if(!eval(rel.side_1, a) || !eval(rel.side_2, b))
+    return;
+
+  // Bring everything into the form side_1 < side_2, side_1 <= side_2,
+  // side_1 == side_2 or side_1 != side_2, swapping sides as needed.
+  expr2tc lhs = rel.side_1, rhs = rel.side_2;
+  bool strict, swap = false;
+  if(is_equality2t(cond) || is_notequal2t(cond))
+  {
+    bool eq = is_equality2t(cond) == polarity;
+    if(eq)
+    {
+      refine(lhs, b);
+      refine(rhs, a);
+    }
+    else
+    {
+      if(b.is_singleton())
+        refine_not_equal(lhs, b.lower);
+      if(a.is_singleton())
+        refine_not_equal(rhs, a.lower);
+    }
+    return;
+  }
+
+  strict = is_lessthan2t(cond) || is_greaterthan2t(cond);
+  if(is_greaterthan2t(cond) || is_greaterthanequal2t(cond))
+    swap = true;
+
+  if(!polarity)
+  {
+    // !(x < y) is y <= x, and !(x <= y) is y < x
+    strict = !strict;
+    swap = !swap;
+  }
+
+  if(swap)
+  {
+    std::swap(lhs, rhs);
+    std::swap(a, b);
+  }
+
+  intervalt l = a, r = b;
+  mp_integer gap = strict ? 1 : 0;
+  l.upper = b.upper - gap;
+  r.lower = a.lower + gap;
+  refine(lhs, l);
+  if(reachable)
+    refine(rhs, r);
+}
+
+void interval_domaint::assume(const expr2tc &cond, bool polarity)
+{
+  if(!reachable)
+    return;
+
+  tvt v = eval_cond(cond);
+  if(!v.is_unknown())
+  {
+    if(v.is_true() != polarity)
+    {
+      reachable = false;
+      values.clear();
+    }
+    return;
+  }
+
+  if(is_not2t(cond))
+    assume(to_not2t(cond).value, !polarity);
+  else if((is_and2t(cond) && polarity) || (is_or2t(cond) && !polarity))
+  {
+    const logic_2ops &op = static_cast<const logic_2ops &>(*cond);
+    assume(op.side_1, polarity);
+    assume(op.side_2, polarity);
+  }
+  else if(is_and2t(cond) || is_or2t(cond))
+  {
+    // Either side may be the one that holds
+    const logic_2ops &op = static_cast<const logic_2ops &>(*cond);
+    interval_domaint other(*this);
+    assume(op.side_1, polarity);
+    other.assume(op.side_2, polarity);
+    join_with(other, false);
+  }
+  else if(
+    is_lessthan2t(cond) || is_lessthanequal2t(cond) ||
+    is_greaterthan2t(cond) || is_greaterthanequal2t(cond) ||
+    is_equality2t(cond) || is_notequal2t(cond))
+    assume_rel(cond, polarity);
+}
+
+void interval_domaint::havoc(const expr2tc &lhs)
+{
+  expr2tc e = lhs;
+  for(;;)
+  {
+    if(is_typecast2t(e))
+      e = to_typecast2t(e).from;
+    else if(is_index2t(e))
+      e = to_index2t(e).source_value;
+    else if(is_member2t(e))
+      e = to_member2t(e).source_value;
+    else if(is_byte_extract2t(e))
+      e = to_byte_extract2t(e).source_value;
+    else
+      break;
+  }
+
+  if(is_symbol2t(e))
+    values.erase(to_symbol2t(e).thename);
+}
+
+void interval_domaint::transform(
+  const namespacet &ns __attribute__((unused)),
+  locationt from,
+  locationt to)
+{
+  if(!reachable)
+    return;
+
+  // Instructions added by the k-induction transformation only run in the
+  // inductive step; symex skips them in the base case and forward condition.
+  // A discharged claim is gone from all three, so assume nothing from their
+  // guards, and let their assignments leave the target unknown.
+  if(from->inductive_step_instruction)
+  {
+    if(from->is_goto() || from->is_assume())
+      return;
+
+    if(from->is_assign())
+    {
+      havoc(to_code_assign2t(from->code).target);
+      return;
+    }
+  }
+
+  switch(from->type)
+  {
+  case GOTO:
+    assume(get_guard(from, to));
+    break;
+
+  case ASSUME:
+    assume(from->guard);
+    break;
+
+  case ASSIGN:
+  {
+    const code_assign2t &assign = to_code_assign2t(from->code);
+    intervalt v;
+    if(
+      is_symbol2t(assign.target) &&
+      tracked->count(to_symbol2t(assign.target).thename) &&
+      eval(assign.source, v))
+      values[to_symbol2t(assign.target).thename] = v;
+    else
+      havoc(assign.target);
+    break;
+  }
+
+  case DECL:
+    values.erase(to_code_decl2t(from->code).value);
+    break;
+
+  case FUNCTION_CALL:
+  {
+    const code_function_call2t &call = to_code_function_call2t(from->code);
+    if(!is_nil_expr(call.ret))
+      havoc(call.ret);
+    break;
+  }
+
+  default:;
+  }
+}
+
+static void add_address_taken(const expr2tc &expr, std::set<irep_idt> &dest)
+{
+  if(is_nil_expr(expr))
+    return;
+
+  if(is_address_of2t(expr))
+  {
+    expr2tc e = to_address_of2t(expr).ptr_obj;
+    for(;;)
+    {
+      if(is_typecast2t(e))
+        e = to_typecast2t(e).from;
+      else if(is_index2t(e))
+        e = to_index2t(e).source_value;
+      else if(is_member2t(e))
+        e = to_member2t(e).source_value;
+      else
+        break;
+    }
+
+    if(is_symbol2t(e))
+      dest.insert(to_symbol2t(e).thename);
+  }
+
+  expr->foreach_operand(
+    [&dest](const expr2tc &e) { add_address_taken(e, dest); });
+}
+
+static void add_symbols(const expr2tc &expr, tracked_varst &dest)
+{
+  if(is_nil_expr(expr))
+    return;
+
+  intervalt range;
+  if(is_symbol2t(expr) && type_range(expr->type, range))
+    dest[to_symbol2t(expr).thename] = range;
+
+  expr->foreach_operand([&dest](const expr2tc &e) { add_symbols(e, dest); });
+}
+
+void interval_analysist::add_vars(const goto_programt &goto_program)
+{
+  forall_goto_program_instructions(i_it, goto_program)
+  {
+    add_symbols(i_it->code, tracked);
+    add_symbols(i_it->guard, tracked);
+  }
+}
+
+void interval_analysist::initialize(const goto_functionst &goto_functions)
+{
+  std::set<irep_idt> address_taken;
+
+  forall_goto_functions(f_it, goto_functions)
+  {
+    add_vars(f_it->second.body);
+    forall_goto_program_instructions(i_it, f_it->second.body)
+    {
+      add_address_taken(i_it->code, address_taken);
+      add_address_taken(i_it->guard, address_taken);
+    }
+  }
+
+  for(auto it = tracked.begin(); it != tracked.end();)
+  {
+    const symbolt *symbol;
+    if(
+      address_taken.count(it->first) || ns.lookup(it->first, symbol) ||
+      symbol->static_lifetime)
+      it = tracked.erase(it);
+    else
+      it++;
+  }
+
+  baset::initialize(goto_functions);
+
+  // Nothing is known on entry to a function, intraprocedurally
+  forall_goto_functions(f_it, goto_functions)
+    if(!f_it->second.body.instructions.empty())
+      (*this)[f_it->second.body.instructions.begin()].reachable = true;
+}
+
+void interval_analysist::generate_state(locationt l)
+{
+  interval_domaint &state = state_map[l];
+  state.tracked = &tracked;
+  state.initialize(ns, l);
+}
+
+static bool is_dischargeable(const goto_programt::instructiont &i)
+{
+  if(!i.is_assert())
+    return false;
+
+  const irep_idt &property = i.location.property();
+  return property == "array bounds" || property == "division-by-zero" ||
+         property == "overflow";
+}
+
+unsigned int discharge_claims(
+  const namespacet &ns,
+  goto_functionst &goto_functions,
+  unsigned int &total)
+{
+  interval_analysist interval_analysis(ns);
+  interval_analysis(goto_functions);
+
+  unsigned int discharged = 0;
+  total = 0;
+
+  Forall_goto_functions(f_it, goto_functions)
+  {
+    goto_programt &body = f_it->second.body;
+
+    // The analysis has no edges for exceptions, so handlers would look
+    // unreachable or be missing states.
+    bool has_exceptions = false;
+    forall_goto_program_instructions(i_it, body)
+      if(i_it->is_throw() || i_it->is_catch())
+        has_exceptions = true;
+
+    Forall_goto_program_instructions(i_it, body)
+    {
+      if(!is_dischargeable(*i_it))
+        continue;
+
+      total++;
+      if(has_exceptions)
+        continue;
+
+      // Leave claims the analysis never reached to symex; it may only be
+      // that they are reached in a way not modelled here.
+      const interval_domaint &state = interval_analysis[i_it];
+      if(state.reachable && state.eval_cond(i_it->guard).is_true())
+      {
+        i_it->make_skip();
+        discharged++;
+      }
+    }
+  }
+
+  return discharged;
+}
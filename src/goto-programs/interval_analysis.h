@@ -0,0 +1,126 @@
+/*******************************************************************\
+
+Module: Interval Analysis
+
+\*******************************************************************/
+
+#ifndef CPROVER_GOTO_PROGRAMS_INTERVAL_ANALYSIS_H
+#define CPROVER_GOTO_PROGRAMS_INTERVAL_ANALYSIS_H
+
+#include <goto-programs/static_analysis.h>
+#include <map>
+#include <util/mp_arith.h>
+#include <util/threeval.h>
+
+// A closed range of integers. Tracked variables always have one that lies
+// within the range of their type.
+struct intervalt
+{
+  mp_integer lower, upper;
+
+  bool is_empty() const
+  {
+    return lower > upper;
+  }
+
+  bool is_singleton() const
+  {
+    return lower == upper;
+  }
+
+  bool contains(const intervalt &other) const
+  {
+    return lower <= other.lower && other.upper <= upper;
+  }
+
+  bool operator==(const intervalt &other) const
+  {
+    return lower == other.lower && upper == other.upper;
+  }
+
+  bool operator!=(const intervalt &other) const
+  {
+    return !(*this == other);
+  }
+};
+
+// Scalar locals worth tracking, with the range of their type: integers
+// that aren't static and never have their address taken, so that nothing
+// but a direct assignment can change them.
+typedef std::map<irep_idt, intervalt> tracked_varst;
+
+class interval_domaint : public abstract_domain_baset
+{
+public:
+  interval_domaint() : tracked(nullptr), reachable(false), changes(0)
+  {
+  }
+
+  const tracked_varst *tracked;
+
+  // Unreachable states are bottom; variables without an entry are top.
+  bool reachable;
+  std::map<irep_idt, intervalt> values;
+
+  void initialize(const namespacet &ns, locationt l) override;
+  void transform(const namespacet &ns, locationt from, locationt to) override;
+  void output(const namespacet &ns, std::ostream &out) const override;
+
+  bool merge(const interval_domaint &b, bool keepnew);
+
+  // Value of an integer expression; false if expr isn't one.
+  bool eval(const expr2tc &expr, intervalt &res) const;
+
+  // Whether a condition holds in every state described.
+  tvt eval_cond(const expr2tc &cond) const;
+
+  // Restrict to the states in which cond has the given value.
+  void assume(const expr2tc &cond, bool polarity = true);
+
+protected:
+  // Number of merges that changed this state, to decide when to widen.
+  unsigned int changes;
+
+  // Join b into this state, widening bounds that grow if widen is set.
+  bool join_with(const interval_domaint &b, bool widen);
+  void havoc(const expr2tc &lhs);
+  void assume_rel(const expr2tc &cond, bool polarity);
+  void refine(const expr2tc &side, const intervalt &bound);
+  void refine_not_equal(const expr2tc &side, const mp_integer &value);
+  const intervalt *tracked_range(const expr2tc &side, irep_idt &name) const;
+};
+
+class interval_analysist : public static_analysist<interval_domaint>
+{
+public:
+  interval_analysist(const namespacet &_ns)
+    : static_analysist<interval_domaint>(_ns)
+  {
+  }
+
+  typedef static_analysist<interval_domaint> baset;
+
+  void initialize(const goto_functionst &goto_functions) override;
+
+protected:
+  tracked_varst tracked;
+
+  // Callees can't touch tracked variables, so calls only havoc their LHS.
+  bool follow_calls() const override
+  {
+    return false;
+  }
+
+  void generate_state(locationt l) override;
+  void add_vars(const goto_programt &goto_program);
+};
+
+// Run the interval analysis and replace the array bounds, division by zero
+// and overflow claims added by goto_check that it proves with SKIPs.
+// Returns the number discharged; total receives the number examined.
+unsigned int discharge_claims(
+  const namespacet &ns,
+  goto_functionst &goto_functions,
+  unsigned int &total);
+
+#endif
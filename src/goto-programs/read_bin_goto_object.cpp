@@ -11,23 +11,72 @@ Date: June 2006
 #include <goto-programs/goto_function_serialization.h>
 #include <goto-programs/goto_program_irep.h>
 #include <goto-programs/read_bin_goto_object.h>
+#include <goto-programs/write_goto_binary.h>
 #include <langapi/mode.h>
+#include <list>
+#include <map>
+#include <streambuf>
 #include <util/base_type.h>
 #include <util/irep_serialization.h>
 #include <util/message_stream.h>
 #include <util/namespace.h>
 #include <util/symbol_serialization.h>
 
-#define BINARY_VERSION 1
+// Reads straight out of a buffer, such as a mapped file, without copying it
+class memory_streambuft : public std::streambuf
+{
+public:
+  memory_streambuft(const char *data, size_t size)
+  {
+    char *p = const_cast<char *>(data);
+    setg(p, p, p + size);
+  }
 
-bool read_bin_goto_object(
+protected:
+  pos_type seekoff(
+    off_type off,
+    std::ios_base::seekdir dir,
+    std::ios_base::openmode which __attribute__((unused))) override
+  {
+    char *p = (dir == std::ios_base::beg) ? eback()
+      : (dir == std::ios_base::cur) ? gptr() : egptr();
+    p += off;
+    if (p < eback() || p > egptr())
+      return pos_type(off_type(-1));
+    setg(eback(), p, egptr());
+    return pos_type(p - eback());
+  }
+};
+
+static void read_names(
   std::istream &in,
-  const std::string &filename,
-  contextt &context,
-  goto_functionst &functions,
-  message_handlert &message_handler)
+  irep_serializationt &irepconverter,
+  std::list<irep_idt> &dest)
+{
+  unsigned count = irepconverter.read_long(in);
+  for (unsigned i=0; i<count && in.good(); i++)
+    dest.push_back(irepconverter.read_string_ref(in));
+}
+
+bin_goto_objectt::bin_goto_objectt(
+  const char *_data,
+  size_t _size,
+  const std::string &_filename,
+  message_handlert &_message_handler)
+  : data(_data),
+    size(_size),
+    filename(_filename),
+    message_handler(_message_handler),
+    symbol_base(0),
+    function_base(0)
+{
+}
+
+bool bin_goto_objectt::read_index()
 {
   message_streamt message_stream(message_handler);
+  memory_streambuft buf(data, size);
+  std::istream in(&buf);
 
   {
     char hdr[4];
@@ -52,36 +101,182 @@ bool read_bin_goto_object(
 
       message_stream.error();
 
-      return false;
+      return true;
     }
   }
 
-  irep_serializationt::ireps_containert ic;
   irep_serializationt irepconverter(ic);
-  symbol_serializationt symbolconverter(ic);
-  goto_function_serializationt gfconverter(ic);
 
   {
     unsigned version=irepconverter.read_long(in);
 
-    if (version!=BINARY_VERSION)
+    if (version!=GOTO_BINARY_VERSION)
     {
       message_stream.str <<
         "The input was compiled with a different version of " <<
         "goto-cc, please recompile";
       message_stream.warning();
-      return false;
+      return true;
     }
   }
 
+  ic.string_table = true;
+  unsigned count = irepconverter.read_long(in);
+  for (unsigned i=0; i<count && in.good(); i++)
+  {
+    unsigned id = irepconverter.read_long(in);
+    if (id>=ic.string_rev_map.size())
+      ic.string_rev_map.resize(id+1, std::pair<bool,dstring>(false, dstring()));
+    ic.string_rev_map[id] =
+      std::pair<bool,dstring>(true, irepconverter.read_string(in));
+  }
+
+  if (read_entries(in, symbol_map, &symbol_order))
+    return true;
+
+  unsigned symbols_length = irepconverter.read_long(in);
+
+  symbol_base = in.tellg();
+  in.seekg(symbols_length, std::ios_base::cur);
+  function_base = in.tellg();
+
+  if (!in.good())
+  {
+    message_stream.str << "`" << filename << "' is truncated";
+    message_stream.error();
+    return true;
+  }
+
+  return false;
+}
+
+bool bin_goto_objectt::read_entries(
+  std::istream &in,
+  entry_mapt &dest,
+  std::vector<irep_idt> *order)
+{
+  irep_serializationt irepconverter(ic);
+
   unsigned count = irepconverter.read_long(in);
+  for (unsigned i=0; i<count && in.good(); i++)
+  {
+    irep_idt name = irepconverter.read_string_ref(in);
+    entryt &entry = dest[name];
+    entry.name = name;
+    entry.offset = irepconverter.read_long(in);
+    entry.length = irepconverter.read_long(in);
+    read_names(in, irepconverter, entry.refs);
+
+    if (order != nullptr)
+      order->push_back(name);
+  }
+
+  if (!in.good())
+  {
+    message_streamt message_stream(message_handler);
+    message_stream.str << "`" << filename << "' is truncated";
+    message_stream.error();
+    return true;
+  }
+
+  return false;
+}
+
+bool bin_goto_objectt::check_entry(const entryt &entry, size_t base)
+{
+  if (base + entry.offset + entry.length <= size)
+    return false;
+
+  message_streamt message_stream(message_handler);
+  message_stream.str << "`" << filename << "' is truncated";
+  message_stream.error();
+  return true;
+}
+
+const bin_goto_objectt::namest &
+bin_goto_objectt::symbol_deps(const irep_idt &name) const
+{
+  entry_mapt::const_iterator it = symbol_map.find(name);
+  assert(it != symbol_map.end());
+  return it->second.refs;
+}
 
-  for (unsigned i=0; i<count; i++)
+bin_goto_objectt::namest bin_goto_objectt::symbol_names() const
+{
+  return namest(symbol_order.begin(), symbol_order.end());
+}
+
+bool bin_goto_objectt::read_symbol(const irep_idt &name, symbolt &dest)
+{
+  entry_mapt::const_iterator it = symbol_map.find(name);
+  assert(it != symbol_map.end());
+
+  const entryt &entry = it->second;
+  if (check_entry(entry, symbol_base))
+    return true;
+
+  memory_streambuft buf(data + symbol_base + entry.offset, entry.length);
+  std::istream in(&buf);
+
+  symbol_serializationt symbolconverter(ic);
+  ic.clear_ireps();
+
+  irept t;
+  symbolconverter.convert(in, t);
+  dest.from_irep(t);
+  return false;
+}
+
+bool bin_goto_objectt::read_functions(goto_functionst &dest)
+{
+  memory_streambuft buf(data + function_base, size - function_base);
+  std::istream in(&buf);
+
+  irep_serializationt irepconverter(ic);
+  goto_function_serializationt gfconverter(ic);
+  ic.clear_ireps();
+
+  unsigned count = irepconverter.read_long(in);
+  for (unsigned i=0; i<count && in.good(); i++)
   {
+    irep_idt name = irepconverter.read_string_ref(in);
+    goto_functiont &f = dest.function_map[name];
+
     irept t;
-    symbolconverter.convert(in, t);
+    gfconverter.convert(in, t);
+    convert(t, f.body);
+    f.body_available = f.body.instructions.size()>0;
+  }
+
+  if (!in.good())
+  {
+    message_streamt message_stream(message_handler);
+    message_stream.str << "`" << filename << "' is truncated";
+    message_stream.error();
+    return true;
+  }
+
+  return false;
+}
+
+bool read_bin_goto_object(
+  const char *data,
+  size_t size,
+  const std::string &filename,
+  contextt &context,
+  goto_functionst &functions,
+  message_handlert &message_handler)
+{
+  bin_goto_objectt object(data, size, filename, message_handler);
+
+  if (object.read_index())
+    return false;
+
+  for (const auto &name : object.symbol_names())
+  {
     symbolt symbol;
-    symbol.from_irep(t);
+    if (object.read_symbol(name, symbol))
+      return false;
 
     if(!symbol.is_type && symbol.type.is_code())
     {
@@ -93,16 +288,21 @@ bool read_bin_goto_object(
     context.add(symbol);
   }
 
-  count = irepconverter.read_long(in);
-  for (unsigned i=0; i<count; i++)
-  {
-    irept t;
-    dstring fname=irepconverter.read_string(in);
-    gfconverter.convert(in, t);
-    goto_functiont &f = functions.function_map[fname];
-    convert(t, f.body);
-    f.body_available = f.body.instructions.size()>0;
-  }
+  object.read_functions(functions);
 
   return false;
 }
+
+bool read_bin_goto_object(
+  std::istream &in,
+  const std::string &filename,
+  contextt &context,
+  goto_functionst &functions,
+  message_handlert &message_handler)
+{
+  std::string data(
+    (std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+  return read_bin_goto_object(
+    data.data(), data.size(), filename, context, functions, message_handler);
+}
@@ -12,8 +12,85 @@ Date: May 2007
 #define READ_BIN_GOTO_OBJECT_H_
 
 #include <goto-programs/goto_functions.h>
+#include <list>
+#include <map>
 #include <util/context.h>
+#include <util/irep_serialization.h>
 #include <util/message.h>
+#include <vector>
+
+/** A goto binary held in memory, decoded piecemeal.
+ *  Reading the index only loads the string table and the names of the
+ *  symbols the binary holds; symbols are decoded one at a time when asked
+ *  for, function bodies all together. The data must outlive this object.
+ */
+class bin_goto_objectt
+{
+public:
+  typedef std::list<irep_idt> namest;
+
+  bin_goto_objectt(
+    const char *_data,
+    size_t _size,
+    const std::string &_filename,
+    message_handlert &_message_handler);
+
+  // Returns true on error, having reported it
+  bool read_index();
+
+  bool has_symbol(const irep_idt &name) const
+  {
+    return symbol_map.find(name) != symbol_map.end();
+  }
+
+  // Symbols that the given one refers to
+  const namest &symbol_deps(const irep_idt &name) const;
+
+  // Returns true on error, having reported it
+  bool read_symbol(const irep_idt &name, symbolt &dest);
+
+  // Symbol names, in the order they were written
+  namest symbol_names() const;
+
+  // Decodes every function body into dest. Returns true on error, having
+  // reported it
+  bool read_functions(goto_functionst &dest);
+
+protected:
+  struct entryt
+  {
+    irep_idt name;
+    unsigned offset;
+    unsigned length;
+    namest refs;
+  };
+
+  typedef std::map<irep_idt, entryt> entry_mapt;
+
+  const char *data;
+  size_t size;
+  std::string filename;
+  message_handlert &message_handler;
+
+  irep_serializationt::ireps_containert ic;
+
+  std::vector<irep_idt> symbol_order;
+  entry_mapt symbol_map;
+  size_t symbol_base;
+
+  size_t function_base;
+
+  bool read_entries(std::istream &in, entry_mapt &dest, std::vector<irep_idt> *order);
+  bool check_entry(const entryt &entry, size_t base);
+};
+
+bool read_bin_goto_object(
+  const char *data,
+  size_t size,
+  const std::string &filename,
+  contextt &context,
+  goto_functionst &functions,
+  message_handlert &msg_hndlr);
 
 bool read_bin_goto_object(
   std::istream &in,
@@ -6,9 +6,17 @@ Author:
 
 \*******************************************************************/
 
+#include <fstream>
 #include <goto-programs/read_bin_goto_object.h>
 #include <goto-programs/read_goto_binary.h>
 
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 void read_goto_binary(
   std::istream &in,
   contextt &context,
@@ -17,3 +25,61 @@ void read_goto_binary(
 {
   read_bin_goto_object(in, "", context, dest, message_handler);
 }
+
+void read_goto_binary(
+  const char *data,
+  size_t size,
+  contextt &context,
+  goto_functionst &dest,
+  message_handlert &message_handler)
+{
+  read_bin_goto_object(data, size, "", context, dest, message_handler);
+}
+
+bool read_goto_binary(
+  const std::string &filename,
+  contextt &context,
+  goto_functionst &dest,
+  message_handlert &message_handler)
+{
+#ifndef _WIN32
+  // Map the file rather than reading it into a copy of its own
+  int fd = open(filename.c_str(), O_RDONLY);
+  if(fd < 0)
+    return true;
+
+  struct stat st;
+  if(fstat(fd, &st) != 0)
+  {
+    close(fd);
+    return true;
+  }
+
+  void *data = nullptr;
+  if(st.st_size != 0)
+  {
+    data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if(data == MAP_FAILED)
+    {
+      close(fd);
+      return true;
+    }
+  }
+
+  read_bin_goto_object(
+    static_cast<const char *>(data), st.st_size, filename, context, dest,
+    message_handler);
+
+  if(data != nullptr)
+    munmap(data, st.st_size);
+  close(fd);
+#else
+  std::ifstream in(filename.c_str(), std::ios::binary);
+  if(!in)
+    return true;
+
+  read_bin_goto_object(in, filename, context, dest, message_handler);
+#endif
+
+  return false;
+}
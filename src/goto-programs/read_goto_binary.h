@@ -20,4 +20,19 @@ void read_goto_binary(
   goto_functionst &dest,
   message_handlert &message_handler);
 
+// Reads a goto binary that is already in memory, e.g. one built in.
+void read_goto_binary(
+  const char *data,
+  size_t size,
+  contextt &context,
+  goto_functionst &dest,
+  message_handlert &message_handler);
+
+// Returns true if the file can't be opened.
+bool read_goto_binary(
+  const std::string &filename,
+  contextt &context,
+  goto_functionst &dest,
+  message_handlert &message_handler);
+
 #endif
@@ -209,7 +209,7 @@ bool static_analysis_baset::visit(
     // Do we want to pull new variables into the new state when tracking?
     bool merge_new_vals = true;
 
-    if(l->is_function_call())
+    if(l->is_function_call() && follow_calls())
     {
       // this is a big special case
       const code_function_call2t &code = to_code_function_call2t(l->code);
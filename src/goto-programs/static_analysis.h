@@ -188,6 +188,13 @@ protected:
     l++;
     return l;
   }
+
+  // Analyses that return false here are intraprocedural: a call is a plain
+  // edge to the next instruction, through the domain's transform.
+  virtual bool follow_calls() const
+  {
+    return true;
+  }
   
   virtual bool merge(statet &a, const statet &b, bool keepnew=false)=0;
   
@@ -9,52 +9,119 @@ Author: CM Wintersteiger
 #include <fstream>
 #include <goto-programs/goto_function_serialization.h>
 #include <goto-programs/write_goto_binary.h>
+#include <sstream>
 #include <util/irep_serialization.h>
 #include <util/message.h>
+#include <util/string_container.h>
 #include <util/symbol_serialization.h>
 
+typedef std::set<irep_idt> namest;
+
+// Names of the symbols an irep refers to, including the parameters of code
+// types, so that a reader can pull in what one symbol needs without
+// decoding the rest of the table.
+static void collect_symbols(const irept &irep, namest &dest)
+{
+  if(irep.id() == "symbol")
+    dest.insert(irep.identifier());
+  else if(irep.id() == "argument" && irep.cmt_identifier() != "")
+    dest.insert(irep.cmt_identifier());
+
+  forall_irep(it, irep.get_sub())
+    collect_symbols(*it, dest);
+
+  forall_named_irep(it, irep.get_named_sub())
+    collect_symbols(it->second, dest);
+}
+
+static void write_names(
+  std::ostream &out,
+  irep_serializationt &irepconverter,
+  const namest &names)
+{
+  write_long(out, names.size());
+  for(const auto &name : names)
+    irepconverter.write_string_ref(out, name);
+}
+
 bool write_goto_binary(
   std::ostream &out,
   const contextt &lcontext,
   goto_functionst &functions)
 {
-  // header
-  out << "GBF";
-  write_long(out, GOTO_BINARY_VERSION);
-
+  // Every string goes into one table up front, and each symbol gets its own
+  // irep numbering, so that readers can decode any one of them without
+  // looking at the others.
   irep_serializationt::ireps_containert irepc;
+  irepc.string_table = true;
   irep_serializationt irepconverter(irepc);
   symbol_serializationt symbolconverter(irepc);
   goto_function_serializationt gfconverter(irepc);
 
-  write_long( out, lcontext.size() );
+  std::ostringstream symbol_index, symbols;
+  write_long(symbol_index, lcontext.size());
 
-  lcontext.foreach_operand(
-    [&symbolconverter, &out] (const symbolt& s)
+  lcontext.foreach_operand_in_order(
+    [&] (const symbolt& s)
     {
-      symbolconverter.convert(s, out);
+      namest deps;
+      collect_symbols(s.value, deps);
+      collect_symbols(s.type, deps);
+
+      std::streamoff offset = symbols.tellp();
+      irepc.clear_ireps();
+      symbolconverter.convert(s, symbols);
+
+      irepconverter.write_string_ref(symbol_index, s.name);
+      write_long(symbol_index, offset);
+      write_long(symbol_index, symbols.tellp() - offset);
+      write_names(symbol_index, irepconverter, deps);
     }
   );
 
+  write_long(symbol_index, symbols.tellp());
+
+  // Bodies are only ever read all together, one after the other
+  std::ostringstream bodies;
+  irepc.clear_ireps();
+
   unsigned cnt=0;
   forall_goto_functions(it, functions)
     if (it->second.body_available)
       cnt++;
 
-  write_long( out, cnt );
+  write_long(bodies, cnt);
 
   for (auto & it : functions.function_map)
   {
-    if (it.second.body_available)
-    {
-      it.second.body.compute_location_numbers();
-      write_string(out, it.first.as_string());
-      gfconverter.convert(it.second, out);
-    }
+    if (!it.second.body_available)
+      continue;
+
+    it.second.body.compute_location_numbers();
+    irepconverter.write_string_ref(bodies, it.first);
+    gfconverter.convert(it.second, bodies);
+  }
+
+  // header
+  out << "GBF";
+  write_long(out, GOTO_BINARY_VERSION);
+
+  unsigned num_strings = 0;
+  for (bool used : irepc.string_map)
+    num_strings += used;
+
+  write_long(out, num_strings);
+  for (unsigned id = 0; id < irepc.string_map.size(); id++)
+  {
+    if (!irepc.string_map[id])
+      continue;
+    write_long(out, id);
+    write_string(out, string_container.get_string(id));
   }
 
-  //irepconverter.output_map(f);
-  //irepconverter.output_string_map(f);
+  out << symbol_index.str();
+  out << symbols.str();
+  out << bodies.str();
 
   return false;
 }
@@ -9,12 +9,16 @@ Author: CM Wintersteiger
 #ifndef CPROVER_GOTO_PROGRAMS_WRITE_GOTO_BINARY_H_
 #define CPROVER_GOTO_PROGRAMS_WRITE_GOTO_BINARY_H_
 
-#define GOTO_BINARY_VERSION 1
+#define GOTO_BINARY_VERSION 4
 
 #include <goto-programs/goto_functions.h>
 #include <ostream>
 #include <util/context.h>
 
+// Layout: "GBF", version, string table, symbol index (name, offset, length
+// and referenced symbols of each), symbols, then the function bodies, each
+// preceded by its name. Each symbol is encoded on its own, so that readers
+// can decode just the ones they need; bodies are read all at once.
 bool write_goto_binary(
   std::ostream &out,
   const contextt &lcontext,
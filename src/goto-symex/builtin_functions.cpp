@@ -618,7 +618,7 @@ goto_symext::intrinsic_get_thread_state(const code_function_call2t &call, reacha
   assert(art.get_cur_state().threads_state.size() >= tid);
 
   // Thread state is simply whether the thread is ended or not.
-  unsigned int flags = (art.get_cur_state().threads_state[tid].thread_ended)
+  unsigned int flags = (art.get_cur_state().get_thread_state(tid).thread_ended)
                        ? 1 : 0;
 
   // Reuse threadid
@@ -27,6 +27,10 @@
 
 unsigned int execution_statet::node_count = 0;
 unsigned int execution_statet::dynamic_counter = 0;
+unsigned long long execution_statet::snapshots = 0;
+unsigned long long execution_statet::threads_shared = 0;
+unsigned long long execution_statet::threads_copied = 0;
+unsigned long long execution_statet::thread_bytes_copied = 0;
 std::map<expr2tc, std::list<unsigned int>> vars_map;
 std::map<expr2tc, bool> is_global;
 
@@ -73,9 +77,10 @@ execution_statet::execution_statet(const goto_functionst &goto_functions,
              (*goto_program).instructions.end(),
              goto_program, 0);
 
-  threads_state.push_back(state);
+  threads_state.push_back(
+    boost::shared_ptr<goto_symex_statet>(new goto_symex_statet(state)));
   preserved_paths.emplace_back();
-  cur_state = &threads_state.front();
+  cur_state = threads_state.front().get();
   cur_state->global_guard.make_true();
   cur_state->global_guard.add(get_guard_identifier());
 
@@ -121,16 +126,15 @@ execution_statet::execution_statet(const execution_statet &ex) :
 
   *this = ex;
 
-  // Regenerate threads state using new objects state_level2 ref
-  threads_state.clear();
-  std::vector<goto_symex_statet>::const_iterator it;
-  for (it = ex.threads_state.begin(); it != ex.threads_state.end(); it++) {
-    goto_symex_statet state(*it, *state_level2, global_value_set);
-    threads_state.push_back(state);
-  }
+  // Thread states are shared with ex, still referring to its level2 and value
+  // set. Each is copied and rebound to ours once we modify it, which for most
+  // threads never happens before we're thrown away.
+  snapshots++;
+  threads_shared += threads_state.size();
 
-  // Reassign which state is currently being worked on.
-  cur_state = &threads_state[active_thread];
+  // Until it's switched to or stepped, the current state is ex's, and must
+  // not be written to.
+  cur_state = threads_state[active_thread].get();
 }
 
 execution_statet&
@@ -179,8 +183,8 @@ execution_statet::operator=(const execution_statet &ex)
   // them, it seems, while keeping the symex stuff ignorant of ex_state.
   // Oooooo, so this is where auto types would be useful...
   for (auto & it : threads_state) {
-    for (goto_symex_statet::call_stackt::iterator it2 = it.call_stack.begin();
-         it2 != it.call_stack.end(); it2++) {
+    for (goto_symex_statet::call_stackt::iterator it2 = it->call_stack.begin();
+         it2 != it->call_stack.end(); it2++) {
       for (auto & it3 : it2->goto_state_map) {
         for (goto_symex_statet::goto_state_listt::iterator it4 = it3.second.begin();
              it4 != it3.second.begin(); it4++) {
@@ -311,7 +315,7 @@ execution_statet::claim(const expr2tc &expr, const std::string &msg)
 void
 execution_statet::symex_goto(const expr2tc &old_guard)
 {
-  pre_goto_guard = threads_state[active_thread].guard;
+  pre_goto_guard = get_thread_state(active_thread).guard;
 
   goto_symext::symex_goto(old_guard);
 
@@ -350,13 +354,86 @@ execution_statet::get_nondet_counter()
 goto_symex_statet &
 execution_statet::get_active_state() {
 
-  return threads_state.at(active_thread);
+  cur_state = &get_mutable_thread_state(active_thread);
+  return *cur_state;
 }
 
 const goto_symex_statet &
 execution_statet::get_active_state() const
 {
-  return threads_state.at(active_thread);
+  return get_thread_state(active_thread);
+}
+
+bool
+execution_statet::is_thread_state_private(unsigned int tid) const
+{
+  const boost::shared_ptr<goto_symex_statet> &state = threads_state.at(tid);
+  return state.unique() &&
+         &state->level2 == static_cast<renaming::level2t *>(state_level2.get()) &&
+         &state->value_set == &global_value_set;
+}
+
+// Approximately how much memory copying a thread state takes: the state,
+// its frames, and the nodes of the containers in them. Expressions and the
+// (persistent) level2 and value set maps of goto_statets are shared rather
+// than copied, and not counted.
+static size_t thread_state_size(const goto_symex_statet &state)
+{
+  const size_t node = 4 * sizeof(void *);
+  size_t size = sizeof(goto_symex_statet);
+
+  size += state.variable_instance_nums.size() *
+          (node + sizeof(std::pair<irep_idt, unsigned>));
+  size += state.function_unwind.size() *
+          (node + sizeof(std::pair<irep_idt, BigInt>));
+
+  for (const auto &frame : state.call_stack) {
+    size += sizeof(frame);
+    size += frame.level1.current_names.size() *
+            (node + sizeof(std::pair<renaming::level1t::name_record, unsigned>));
+    size += (frame.local_variables.size() +
+             frame.declaration_history.size()) *
+            (node + sizeof(renaming::level2t::name_record));
+    size += frame.loop_iterations.size() *
+            (node + sizeof(std::pair<unsigned, BigInt>));
+    for (const auto &it : frame.goto_state_map)
+      size += node + it.second.size() *
+                       (node + sizeof(goto_symex_statet::goto_statet));
+  }
+
+  return size;
+}
+
+goto_symex_statet &
+execution_statet::get_mutable_thread_state(unsigned int tid)
+{
+  if (!is_thread_state_private(tid)) {
+    boost::shared_ptr<goto_symex_statet> &state = threads_state.at(tid);
+    state = boost::shared_ptr<goto_symex_statet>(
+      new goto_symex_statet(*state, *state_level2, global_value_set));
+
+    // execute_guard only refreshes the global guard of private states
+    state->global_guard.make_true();
+    state->global_guard.add(get_guard_identifier());
+
+    threads_copied++;
+    thread_bytes_copied += thread_state_size(*state);
+  }
+
+  return *threads_state[tid];
+}
+
+void
+execution_statet::output_snapshot_stats(std::ostream &out)
+{
+  out << "Execution state snapshots: " << snapshots << std::endl;
+  out << "Thread states shared: " << threads_shared
+      << ", copied: " << threads_copied
+      << ", never copied: " << threads_shared - threads_copied << std::endl;
+  out << "Thread state bytes copied: " << thread_bytes_copied;
+  if (snapshots != 0)
+    out << " (" << thread_bytes_copied / snapshots << " per context switch)";
+  out << std::endl;
 }
 
 unsigned int
@@ -394,7 +471,7 @@ execution_statet::switch_to_thread(unsigned int i)
 
   last_active_thread = active_thread;
   active_thread = i;
-  cur_state = &threads_state[active_thread];
+  cur_state = &get_mutable_thread_state(active_thread);
 }
 
 bool
@@ -404,10 +481,10 @@ execution_statet::dfs_explore_thread(unsigned int tid)
     if(DFS_traversed.at(tid))
       return false;
 
-    if(threads_state.at(tid).call_stack.empty())
+    if(get_thread_state(tid).call_stack.empty())
       return false;
 
-    if(threads_state.at(tid).thread_ended)
+    if(get_thread_state(tid).thread_ended)
       return false;
 
     DFS_traversed.at(tid) = true;
@@ -478,7 +555,7 @@ execution_statet::preserve_last_paths()
 {
   // If the thread terminated, there are no paths to preserve: this is the final
   // switching away.
-  if (threads_state[last_active_thread].thread_ended)
+  if (get_thread_state(last_active_thread).thread_ended)
     return;
 
   // Examine the current execution state and the last insn, deciding which paths
@@ -488,7 +565,9 @@ execution_statet::preserve_last_paths()
   // need to find the branch that was generated there.
 
   auto &pp = preserved_paths[last_active_thread];
-  auto &ls = threads_state[last_active_thread];
+  // Paths preserved from here are built on our level2 and value set, so this
+  // needs to be our own copy of the thread.
+  auto &ls = get_mutable_thread_state(last_active_thread);
   assert(pp.size() == 0 && "Unmerged preserved paths in ex_state");
   assert(last_insn != nullptr && "Last insn unset in preserve_last_paths");
 
@@ -566,7 +645,7 @@ execution_statet::preserve_last_paths()
     // It's unclear how to distinguish this case from an error in this code
     // here.
     // XXX methodise this
-    threads_state[last_active_thread].thread_ended = true;
+    ls.thread_ended = true;
     atomic_numbers[last_active_thread] = 0;
   }
 }
@@ -624,7 +703,7 @@ execution_statet::is_cur_state_guard_false()
 
   // So, can the assumption actually be true? If enabled, ask the solver.
   if (smt_thread_guard) {
-    expr2tc parent_guard = threads_state[active_thread].guard.as_expr();
+    expr2tc parent_guard = get_thread_state(active_thread).guard.as_expr();
 
     runtime_encoded_equationt *rte = dynamic_cast<runtime_encoded_equationt*>
                                                  (target.get());
@@ -662,7 +741,7 @@ execution_statet::execute_guard()
   if (!pre_goto_guard.is_true())
     parent_guard = pre_goto_guard.as_expr();
   else
-    parent_guard = threads_state[last_active_thread].guard.as_expr();
+    parent_guard = get_thread_state(last_active_thread).guard.as_expr();
 
   // Rename value, allows its use in other renamed exprs
   state_level2->make_assignment(guard_expr, expr2tc(), expr2tc());
@@ -675,7 +754,7 @@ execution_statet::execute_guard()
   target->assumption(guardt().as_expr(), assumpt, get_active_state().source);
 
   guardt old_guard;
-  old_guard.add(threads_state[last_active_thread].guard.as_expr());
+  old_guard.add(get_thread_state(last_active_thread).guard.as_expr());
 
   // If we simplified the global guard expr to false, write that to thread
   // guards, not the symbolic guard name. This is the only way to bail out of
@@ -683,10 +762,14 @@ execution_statet::execute_guard()
   if (is_false(parent_guard))
     guard_expr = parent_guard;
 
-  for (auto & i : threads_state)
+  // Shared thread states get theirs when they're copied.
+  for (unsigned int tid = 0; tid < threads_state.size(); tid++)
   {
-    i.global_guard.make_true();
-    i.global_guard.add(get_guard_identifier());
+    if (!is_thread_state_private(tid))
+      continue;
+
+    threads_state[tid]->global_guard.make_true();
+    threads_state[tid]->global_guard.add(get_guard_identifier());
   }
 
   // Check to see whether or not the state guard is false, indicating we've
@@ -710,7 +793,8 @@ execution_statet::add_thread(const goto_programt *prog)
   new_state.source.thread_nr = thread_nr;
   new_state.global_guard.make_true();
   new_state.global_guard.add(get_guard_identifier());
-  threads_state.push_back(new_state);
+  threads_state.push_back(
+    boost::shared_ptr<goto_symex_statet>(new goto_symex_statet(new_state)));
   preserved_paths.emplace_back();
   atomic_numbers.push_back(0);
 
@@ -722,9 +806,6 @@ execution_statet::add_thread(const goto_programt *prog)
 
   thread_start_data.emplace_back();
 
-  // We invalidated all threads_state refs, so reset cur_state ptr.
-  cur_state = &threads_state[active_thread];
-
   // Update MPOR tracking data with newly initialized thread
   thread_last_reads.emplace_back();
   thread_last_writes.emplace_back();
@@ -741,7 +822,7 @@ execution_statet::add_thread(const goto_programt *prog)
 
   // While we've recorded the new thread as starting in the designated program,
   // it might not run immediately, thus must have it's path preserved:
-  preserved_paths[thread_nr].push_back(std::make_pair(prog->instructions.begin(), goto_statet(threads_state[thread_nr])));
+  preserved_paths[thread_nr].push_back(std::make_pair(prog->instructions.begin(), goto_statet(get_thread_state(thread_nr))));
 
 
   return threads_state.size() - 1; // thread ID, zero based
@@ -1027,10 +1108,10 @@ bool
 execution_statet::can_execution_continue() const
 {
 
-  if (threads_state[active_thread].thread_ended)
+  if (get_thread_state(active_thread).thread_ended)
     return false;
 
-  if (threads_state[active_thread].call_stack.empty())
+  if (get_thread_state(active_thread).call_stack.empty())
     return false;
 
   return true;
@@ -1048,7 +1129,7 @@ execution_statet::generate_hash() const
   std::string str = state.to_string();
 
   for (const auto & it : threads_state) {
-    goto_programt::const_targett pc = it.source.pc;
+    goto_programt::const_targett pc = it->source.pc;
     int id = pc->location_number;
     std::stringstream s;
     s << id;
@@ -1075,7 +1156,7 @@ execution_statet::update_hash_for_assignment(const expr2tc &rhs)
 void
 execution_statet::print_stack_traces(unsigned int indent) const
 {
-  std::vector<goto_symex_statet>::const_iterator it;
+  std::vector<boost::shared_ptr<goto_symex_statet> >::const_iterator it;
   std::string spaces = std::string("");
   unsigned int i;
 
@@ -1085,7 +1166,7 @@ execution_statet::print_stack_traces(unsigned int indent) const
   i = 0;
   for (it = threads_state.begin(); it != threads_state.end(); it++) {
     std::cout << spaces << "Thread " << i++ << ":" << std::endl;
-    it->print_stack_trace(indent + 2);
+    (*it)->print_stack_trace(indent + 2);
     std::cout << std::endl;
   }
 }
@@ -1094,7 +1175,7 @@ void
 execution_statet::switch_to_monitor()
 {
 
-  if (threads_state[monitor_tid].thread_ended) {
+  if (get_thread_state(monitor_tid).thread_ended) {
     if (!mon_thread_warning) {
       std::cerr << "Switching to ended monitor; you need to increase its context or prefix bound" << std::endl;
       mon_thread_warning = true;
@@ -1114,8 +1195,8 @@ execution_statet::switch_to_monitor()
     // an extremely bad plan.
     last_active_thread = active_thread;
     active_thread = monitor_tid;
-    cur_state = &threads_state[active_thread];
-    cur_state->guard = threads_state[last_active_thread].guard;
+    cur_state = &get_mutable_thread_state(active_thread);
+    cur_state->guard = get_thread_state(last_active_thread).guard;
   } else {
     assert(0 && "Switching to monitor thread from self\n");
   }
@@ -1127,7 +1208,7 @@ execution_statet::switch_away_from_monitor()
 
   // Occurs when we rerun the automata to discover whether or not the property
   // has been violated or not.
-  if (threads_state[monitor_tid].thread_ended)
+  if (get_thread_state(monitor_tid).thread_ended)
     return;
 
   assert(tid_is_set && "Must set monitor thread before switching from mon\n");
@@ -1140,9 +1221,9 @@ execution_statet::switch_away_from_monitor()
   // an extremely bad plan.
   last_active_thread = active_thread;
   active_thread = monitor_from_tid;
-  cur_state = &threads_state[active_thread];
+  cur_state = &get_mutable_thread_state(active_thread);
 
-  cur_state->guard = threads_state[monitor_tid].guard;
+  cur_state->guard = get_thread_state(monitor_tid).guard;
 
   mon_from_tid = false;
 }
@@ -1153,7 +1234,7 @@ execution_statet::kill_monitor_thread()
   assert(monitor_tid != active_thread &&
          "You cannot kill monitor thread _from_ the monitor thread\n");
 
-  threads_state[monitor_tid].thread_ended = true;
+  get_mutable_thread_state(monitor_tid).thread_ended = true;
 }
 
 static void replace_symbol_names(exprt &e, const std::string&& prefix, std::map<std::string, std::string> &strings, std::set<std::string> &used_syms)
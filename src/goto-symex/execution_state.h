@@ -299,6 +299,30 @@ class execution_statet : public goto_symext
   goto_symex_statet & get_active_state();
   const goto_symex_statet & get_active_state() const;
 
+  /**
+   *  Get reference to a thread's state, for reading only. It may be shared
+   *  with other clones of this ex_state, and so still refer to the level2
+   *  and value set of the one that last modified it.
+   *  @param tid Thread ID of state to fetch.
+   *  @return Reference to that thread's state.
+   */
+  const goto_symex_statet &get_thread_state(unsigned int tid) const
+  {
+    return *threads_state.at(tid);
+  }
+
+  /**
+   *  Get reference to a thread's state, for modification. If it's shared
+   *  with another clone, or still refers to another ex_state's level2 and
+   *  value set, it's copied first.
+   *  @param tid Thread ID of state to fetch.
+   *  @return Reference to that thread's state, private to this ex_state.
+   */
+  goto_symex_statet &get_mutable_thread_state(unsigned int tid);
+
+  /** Whether the state of thread tid belongs to this ex_state alone. */
+  bool is_thread_state_private(unsigned int tid) const;
+
   /**
    *  Get atomic number count for current thread state.
    *  @see atomic_numbers
@@ -518,8 +542,10 @@ class execution_statet : public goto_symext
   /** Pointer to reachability_treet that owns this ex_state */
   reachability_treet *owning_rt;
   /** Stack of thread states. The index into this vector is the thread ID of
-   *  the goto_symex_statet at that location */
-  std::vector<goto_symex_statet> threads_state;
+   *  the goto_symex_statet at that location. Clones of this ex_state share
+   *  these until one of them modifies a thread, so access them through
+   *  get_thread_state and get_mutable_thread_state. */
+  std::vector<boost::shared_ptr<goto_symex_statet> > threads_state;
   /** Preserved paths. After switching out of a thread, only the paths active
    *  at the time the switch occurred are allowed to live, and are stored
    *  here. Format is: for each thread, a list of paths, which are made up
@@ -630,6 +656,17 @@ class execution_statet : public goto_symext
   public:
   static unsigned int node_count;
 
+  /** Snapshot statistics: number of clones taken, thread states they
+   *  shared, and the copies (and their approximate size) made later when a
+   *  shared thread state was modified. */
+  static unsigned long long snapshots;
+  static unsigned long long threads_shared;
+  static unsigned long long threads_copied;
+  static unsigned long long thread_bytes_copied;
+
+  /** Print the snapshot statistics, for --memstats */
+  static void output_snapshot_stats(std::ostream &out);
+
   friend void build_goto_symex_classes();
 };
 
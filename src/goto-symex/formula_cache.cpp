@@ -0,0 +1,305 @@
+/*******************************************************************\
+
+Module: On-disk cache of decision procedure results
+
+\*******************************************************************/
+
+#include <ac_config.h>
+#include <cstdio>
+#include <fstream>
+#include <goto-symex/formula_cache.h>
+#include <solvers/solve.h>
+#include <sstream>
+#include <util/config.h>
+#include <util/irep_serialization.h>
+#include <util/migrate.h>
+
+#ifndef _WIN32
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+#endif
+
+#define FORMULA_CACHE_VERSION 1
+
+// Options that change which solver is used or how the formula is encoded.
+// Anything else only affects how the equation was produced, which is already
+// captured by hashing the equation itself.
+static const char *encoding_options[] = {
+  "int-encoding",
+  "tuple-node-flattener",
+  "tuple-sym-flattener",
+  "array-flattener",
+  "smtlib-solver-prog",
+};
+
+static void hash_string(crypto_hash &hash, const std::string &str)
+{
+  unsigned int len = str.size();
+  hash.ingest(&len, sizeof(len));
+  hash.ingest(str.data(), len);
+}
+
+static void hash_expr(crypto_hash &hash, const expr2tc &expr)
+{
+  uint8_t present = !is_nil_expr(expr);
+  hash.ingest(&present, sizeof(present));
+  if(present)
+    expr->hash(hash);
+}
+
+formula_cachet::formula_cachet(
+  const std::string &_dir,
+  const optionst &_options)
+  : dir(_dir),
+    options(_options)
+{
+#ifndef _WIN32
+  // Only the last component is created; a missing parent is the user's
+  // problem, and will show up as records failing to be written.
+  mkdir(dir.c_str(), 0777);
+#endif
+}
+
+void formula_cachet::compute_key(const symex_target_equationt &eq)
+{
+  hash_string(hash, ESBMC_VERSION);
+
+  for(unsigned int i = 0; i < total_num_of_solvers; i++)
+    if(options.get_bool_option(list_of_all_solvers[i]))
+      hash_string(hash, list_of_all_solvers[i]);
+
+  for(const char *opt : encoding_options)
+  {
+    hash_string(hash, opt);
+    hash_string(hash, options.get_option(opt));
+  }
+
+  uint8_t fixed = config.ansi_c.use_fixed_for_float;
+  hash.ingest(&fixed, sizeof(fixed));
+
+  for(const auto &step : eq.SSA_steps)
+  {
+    uint8_t type = step.type;
+    uint8_t ignore = step.ignore;
+    hash.ingest(&type, sizeof(type));
+    hash.ingest(&ignore, sizeof(ignore));
+
+    // Sliced steps never reach the solver nor the counterexample, but still
+    // occupy an index in the records below.
+    if(step.ignore)
+      continue;
+
+    unsigned int thread_nr = step.source.thread_nr;
+    uint8_t assignment_type = step.assignment_type;
+    hash.ingest(&thread_nr, sizeof(thread_nr));
+    hash.ingest(&assignment_type, sizeof(assignment_type));
+
+    hash_expr(hash, step.guard);
+    hash_expr(hash, step.lhs);
+    hash_expr(hash, step.rhs);
+    hash_expr(hash, step.original_lhs);
+    hash_expr(hash, step.cond);
+    for(const auto &arg : step.output_args)
+      hash_expr(hash, arg);
+
+    // Not part of the formula, but part of the counterexample we replay.
+    hash_string(hash, step.comment);
+    hash_string(hash, step.format_string);
+    if(step.source.is_set)
+      hash_string(hash, step.source.pc->location.as_string());
+    for(const auto &frame : step.stack_trace)
+      hash_string(hash, id2string(frame.function));
+  }
+
+  hash.fin();
+}
+
+std::string formula_cachet::record_name() const
+{
+  return dir + "/" + hash.to_string();
+}
+
+bool formula_cachet::lookup(
+  const symex_target_equationt &eq,
+  smt_convt::resultt &res,
+  goto_tracet &goto_trace)
+{
+  std::ifstream in(record_name().c_str(), std::ios::binary);
+  if(!in)
+    return false;
+
+  return read_record(in, eq, res, goto_trace);
+}
+
+bool formula_cachet::read_record(
+  std::istream &in,
+  const symex_target_equationt &eq,
+  smt_convt::resultt &res,
+  goto_tracet &goto_trace)
+{
+  if(in.get() != 'E' || in.get() != 'F' || in.get() != 'C')
+    return false;
+
+  irep_serializationt::ireps_containert ic;
+  irep_serializationt irepconverter(ic);
+
+  if(irepconverter.read_long(in) != FORMULA_CACHE_VERSION)
+    return false;
+
+  if(irepconverter.read_long(in) != eq.SSA_steps.size())
+    return false;
+
+  res = static_cast<smt_convt::resultt>(irepconverter.read_long(in));
+  if(res != smt_convt::P_SATISFIABLE)
+    return in.good() && res == smt_convt::P_UNSATISFIABLE;
+
+  goto_tracet trace;
+  unsigned int num_steps = irepconverter.read_long(in);
+  auto it = eq.SSA_steps.begin();
+  unsigned int pos = 0;
+  for(unsigned int step_nr = 1; step_nr <= num_steps; step_nr++)
+  {
+    unsigned int idx = irepconverter.read_long(in);
+    if(!in.good() || idx < pos || idx >= eq.SSA_steps.size())
+      return false;
+
+    for(; pos < idx; pos++)
+      it++;
+
+    const symex_target_equationt::SSA_stept &SSA_step = *it;
+
+    trace.steps.emplace_back();
+    goto_trace_stept &goto_trace_step = trace.steps.back();
+
+    goto_trace_step.thread_nr = SSA_step.source.thread_nr;
+    goto_trace_step.lhs = SSA_step.lhs;
+    goto_trace_step.rhs = SSA_step.rhs;
+    goto_trace_step.pc = SSA_step.source.pc;
+    goto_trace_step.comment = SSA_step.comment;
+    goto_trace_step.original_lhs = SSA_step.original_lhs;
+    goto_trace_step.type = SSA_step.type;
+    goto_trace_step.step_nr = step_nr;
+    goto_trace_step.format_string = SSA_step.format_string;
+    goto_trace_step.stack_trace = SSA_step.stack_trace;
+    goto_trace_step.guard = irepconverter.read_long(in);
+
+    irept value;
+    if(irepconverter.read_long(in))
+    {
+      irepconverter.reference_convert(in, value);
+      migrate_expr(static_cast<const exprt &>(value), goto_trace_step.value);
+    }
+
+    unsigned int num_args = irepconverter.read_long(in);
+    for(unsigned int i = 0; i < num_args; i++)
+    {
+      irepconverter.reference_convert(in, value);
+      expr2tc arg;
+      migrate_expr(static_cast<const exprt &>(value), arg);
+      goto_trace_step.output_args.push_back(arg);
+    }
+  }
+
+  if(!in.good())
+    return false;
+
+  goto_trace.steps.swap(trace.steps);
+  return true;
+}
+
+void formula_cachet::store(
+  const symex_target_equationt &eq,
+  smt_convt::resultt res,
+  smt_convt &smt_conv)
+{
+  if(res != smt_convt::P_SATISFIABLE && res != smt_convt::P_UNSATISFIABLE)
+    return;
+
+  // Write to a private file and rename it into place, so that concurrent
+  // runs sharing a cache never observe a partial record.
+  std::ostringstream tmp_name;
+  tmp_name << record_name() << ".tmp";
+#ifndef _WIN32
+  tmp_name << "." << getpid();
+#endif
+
+  {
+    std::ofstream out(tmp_name.str().c_str(), std::ios::binary);
+    if(!out)
+      return;
+
+    write_record(out, eq, res, smt_conv);
+
+    if(!out.good())
+    {
+      out.close();
+      remove(tmp_name.str().c_str());
+      return;
+    }
+  }
+
+  if(rename(tmp_name.str().c_str(), record_name().c_str()) != 0)
+    remove(tmp_name.str().c_str());
+}
+
+void formula_cachet::write_record(
+  std::ostream &out,
+  const symex_target_equationt &eq,
+  smt_convt::resultt res,
+  smt_convt &smt_conv)
+{
+  irep_serializationt::ireps_containert ic;
+  irep_serializationt irepconverter(ic);
+
+  out << "EFC";
+  write_long(out, FORMULA_CACHE_VERSION);
+  write_long(out, eq.SSA_steps.size());
+  write_long(out, res);
+
+  if(res == smt_convt::P_SATISFIABLE)
+  {
+    // Mirrors build_goto_trace: record the steps that would make it into
+    // the counterexample, along with the model values they display.
+    std::vector<unsigned int> indexes;
+    unsigned int idx = 0;
+    for(const auto &SSA_step : eq.SSA_steps)
+    {
+      if(smt_conv.l_get(SSA_step.guard_ast) == tvt(true)
+         && !(SSA_step.assignment_type == symex_target_equationt::HIDDEN
+              && SSA_step.is_assignment()))
+        indexes.push_back(idx);
+      idx++;
+    }
+
+    write_long(out, indexes.size());
+
+    auto it = eq.SSA_steps.begin();
+    unsigned int pos = 0;
+    for(unsigned int i : indexes)
+    {
+      for(; pos < i; pos++)
+        it++;
+
+      const symex_target_equationt::SSA_stept &SSA_step = *it;
+      write_long(out, i);
+
+      bool guard = false;
+      if(SSA_step.is_assert() || SSA_step.is_assume())
+        guard = !smt_conv.l_get(SSA_step.cond_ast).is_false();
+      write_long(out, guard);
+
+      write_long(out, !is_nil_expr(SSA_step.lhs));
+      if(!is_nil_expr(SSA_step.lhs))
+        irepconverter.reference_convert(
+          migrate_expr_back(smt_conv.get(SSA_step.lhs)), out);
+
+      write_long(out, SSA_step.converted_output_args.size());
+      for(const auto &arg : SSA_step.converted_output_args)
+      {
+        expr2tc value = is_constant_expr(arg) ? arg : smt_conv.get(arg);
+        irepconverter.reference_convert(migrate_expr_back(value), out);
+      }
+    }
+  }
+}
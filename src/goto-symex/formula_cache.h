@@ -0,0 +1,67 @@
+/*******************************************************************\
+
+Module: On-disk cache of decision procedure results
+
+\*******************************************************************/
+
+#ifndef CPROVER_GOTO_SYMEX_FORMULA_CACHE_H
+#define CPROVER_GOTO_SYMEX_FORMULA_CACHE_H
+
+#include <goto-symex/goto_trace.h>
+#include <goto-symex/symex_target_equation.h>
+#include <solvers/smt/smt_conv.h>
+#include <util/crypto_hash.h>
+#include <util/options.h>
+
+// A directory of result records, one file per formula. Records are keyed on
+// a hash of the sliced SSA equation together with the options that select
+// and configure the solver, so that re-verifying an unchanged program (or an
+// unchanged k step) can skip the decision procedure entirely. A satisfiable
+// record also carries the model values needed to rebuild the counterexample.
+
+class formula_cachet
+{
+public:
+  formula_cachet(const std::string &_dir, const optionst &options);
+
+  const crypto_hash &key() const { return hash; }
+
+  // Hash the equation into the key; must be called before lookup or store.
+  void compute_key(const symex_target_equationt &eq);
+
+  // Returns true on a hit; for satisfiable results goto_trace is filled in.
+  bool lookup(
+    const symex_target_equationt &eq,
+    smt_convt::resultt &res,
+    goto_tracet &goto_trace);
+
+  // Record the outcome of solving eq with smt_conv. Only definite verdicts
+  // are stored; unknown results and errors are not worth remembering.
+  void store(
+    const symex_target_equationt &eq,
+    smt_convt::resultt res,
+    smt_convt &smt_conv);
+
+  // The record format on its own, for passing results between processes.
+  // read_record returns true if a complete record for eq was read.
+  static bool read_record(
+    std::istream &in,
+    const symex_target_equationt &eq,
+    smt_convt::resultt &res,
+    goto_tracet &goto_trace);
+
+  static void write_record(
+    std::ostream &out,
+    const symex_target_equationt &eq,
+    smt_convt::resultt res,
+    smt_convt &smt_conv);
+
+protected:
+  std::string dir;
+  const optionst &options;
+  crypto_hash hash;
+
+  std::string record_name() const;
+};
+
+#endif
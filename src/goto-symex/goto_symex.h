@@ -230,9 +230,11 @@ protected:
    *  This combines together two thread states by using if-then-elses to decide
    *  the new value of a variable, according to the truth of the guards of the
    *  states being joined.
+   *  Only the names written since goto_state was forked off are considered.
    *  @param goto_state The previous jumps state to be merged into the current
+   *  @return Number of phi assignments made.
    */
-  void phi_function(const statet::goto_statet &goto_state);
+  unsigned int phi_function(const statet::goto_statet &goto_state);
 
   /**
    *  Test whether unwinding bound has been exceeded.
@@ -96,6 +96,9 @@ public:
     value_sett value_set;
     guardt guard;
     unsigned int thread_id;
+    /** Position of the state's level2 write log when this was forked off;
+     *  names not written since then are the same on both sides. */
+    size_t level2_log_pos;
 
     explicit
     goto_statet(const goto_symex_statet &s) :
@@ -104,7 +107,8 @@ public:
       level2(*level2_ptr),
       value_set(s.value_set),
       guard(s.guard),
-      thread_id(s.source.thread_nr)
+      thread_id(s.source.thread_nr),
+      level2_log_pos(s.level2.write_log.position())
     {
     }
 
@@ -114,7 +118,8 @@ public:
       level2(*level2_ptr),
       value_set(s.value_set),
       guard(s.guard),
-      thread_id(s.thread_id) {}
+      thread_id(s.thread_id),
+      level2_log_pos(s.level2_log_pos) {}
 
     goto_statet &operator=(const goto_statet &ref __attribute__((unused)))
     {
@@ -319,7 +319,7 @@ void generate_goto_trace_in_violation_graphml_format(
 	    current_edge_p.endline = line_number;
 	    int p_startoffset = 0;
 	    int p_endoffset = 0;
-	    get_offsets_for_line_using_wc(current_ver_file, line_number, p_startoffset, p_endoffset);
+	    get_offsets_for_line(current_ver_file, line_number, p_startoffset, p_endoffset);
 	    current_edge_p.startoffset = p_startoffset;
 	    current_edge_p.endoffset = p_endoffset;
 	  }
@@ -509,7 +509,7 @@ void generate_goto_trace_in_correctness_graphml_format(
         current_edge_p.endline = line_number;
         int p_startoffset = 0;
         int p_endoffset = 0;
-        get_offsets_for_line_using_wc(current_ver_file, line_number, p_startoffset, p_endoffset);
+        get_offsets_for_line(current_ver_file, line_number, p_startoffset, p_endoffset);
         current_edge_p.startoffset = p_startoffset;
         current_edge_p.endoffset = p_endoffset;
       }
@@ -52,6 +52,10 @@ reachability_treet::reachability_treet(
   round_robin = options.get_bool_option("round-robin");
   schedule = options.get_bool_option("schedule");
 
+  if (state_hashing)
+    hit_hashes = std::make_shared<state_hash_sett>(
+      16, false, options.get_option("state-hash-spill"));
+
   if (options.get_bool_option("no-por"))
     por = false;
   else
@@ -124,10 +128,7 @@ reachability_treet::check_for_hash_collision() const
 
   crypto_hash hash;
   hash = ex_state.generate_hash();
-  if (hit_hashes.find(hash) != hit_hashes.end())
-    return true;
-
-  return false;
+  return hit_hashes->contains(hash);
 }
 
 void
@@ -146,7 +147,7 @@ reachability_treet::update_hash_collision_set()
 
   crypto_hash hash;
   hash = ex_state.generate_hash();
-  hit_hashes.insert(hash);
+  hit_hashes->insert(hash);
 }
 
 void
@@ -181,6 +182,44 @@ reachability_treet::step_next_state()
 {
 
   next_thread_id = decide_ileave_direction(get_cur_state());
+
+  if (next_thread_id != get_cur_state().threads_state.size()) {
+    create_next_state();
+    return true;
+  }
+
+  return false;
+}
+
+bool
+reachability_treet::backtrack_next_state()
+{
+
+  next_thread_id = decide_ileave_direction(get_cur_state());
+
+  while (fork_worker &&
+         next_thread_id != get_cur_state().threads_state.size()) {
+    int forked = fork_worker();
+    if (forked < 0)
+      break;
+
+    if (forked > 0) {
+      // A worker has taken that context switch; try the next one.
+      next_thread_id = decide_ileave_direction(get_cur_state());
+      continue;
+    }
+
+    // We're the new worker: everything up to and including the current
+    // state is someone else's to backtrack into.
+    for (auto it = execution_states.begin(); ; it++) {
+      for (auto && traversed : (*it)->DFS_traversed)
+        traversed = true;
+      if (it == cur_state_it)
+        break;
+    }
+    break;
+  }
+
   if (next_thread_id != get_cur_state().threads_state.size()) {
     create_next_state();
     return true;
@@ -284,7 +323,7 @@ bool reachability_treet::reset_to_unexplored_state()
   auto it = cur_state_it--;
   execution_states.erase(it);
 
-  while(execution_states.size() > 0 && !step_next_state()) {
+  while(execution_states.size() > 0 && !backtrack_next_state()) {
     it = cur_state_it--;
     execution_states.erase(it);
   }
@@ -319,7 +358,7 @@ void reachability_treet::go_next_state()
     cur_state_it++;
   else
   {
-    while(execution_states.size() > 0 && !step_next_state())
+    while(execution_states.size() > 0 && !backtrack_next_state())
     {
       it = cur_state_it;
       cur_state_it--;
@@ -345,7 +384,8 @@ reachability_treet::dfs_position::dfs_position(const reachability_treet &rt)
   for (it = rt.execution_states.begin(); it != rt.execution_states.end();it++){
     reachability_treet::dfs_position::dfs_state state;
     auto ex = *it;
-    state.location_number = ex->get_active_state().source.pc->location_number;
+    state.location_number =
+      ex->get_thread_state(ex->active_thread).source.pc->location_number;
     state.num_threads = ex->threads_state.size();
     state.explored = ex->DFS_traversed;
 
@@ -576,7 +616,8 @@ reachability_treet::get_ileave_direction_from_scheduling() const
     // If the guard on this execution trace is false, no context switches are
     // going to be run over in the future and just general randomness is going to
     // occur. So there's absolutely no reason exploring further.
-    if (get_cur_state().get_active_state().guard.is_false()) {
+    const execution_statet &ex_state = get_cur_state();
+    if (ex_state.get_active_state().guard.is_false()) {
           std::cout << "This trace's guard is false; it will not be evaulated." << std::endl;
           exit(1);
     }
@@ -618,13 +659,13 @@ reachability_treet::check_thread_viable(unsigned int tid, bool quiet) const
     return false;
   }
 
-  if (ex.threads_state.at(tid).call_stack.empty()) {
+  if (ex.get_thread_state(tid).call_stack.empty()) {
     if (!quiet)
       std::cout << "Thread unschedulable due to empty call stack" << std::endl;
     return false;
   }
 
-  if (ex.threads_state.at(tid).thread_ended) {
+  if (ex.get_thread_state(tid).thread_ended) {
     if (!quiet)
       std::cout << "That thread has ended" << std::endl;
     return false;
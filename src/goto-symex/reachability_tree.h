@@ -11,10 +11,12 @@ Author: Lucas Cordeiro, lcc08r@ecs.soton.ac.uk
 
 #include <boost/shared_ptr.hpp>
 #include <deque>
+#include <functional>
 #include <goto-programs/goto_program.h>
 #include <goto-symex/execution_state.h>
 #include <goto-symex/goto_symex.h>
 #include <goto-symex/renaming.h>
+#include <goto-symex/state_hash_set.h>
 #include <goto-symex/symex_target_equation.h>
 #include <iostream>
 #include <map>
@@ -187,6 +189,16 @@ public:
    */
   bool step_next_state();
 
+  /**
+   *  Take the next unexplored context switch while backtracking.
+   *  Like step_next_state, but first offers each unexplored switch to
+   *  fork_worker, so that a worker process can explore it instead. Only
+   *  called when backtracking, so that a worker always starts on an
+   *  interleaving of its own.
+   *  @return True if context switch was generated and taken
+   */
+  bool backtrack_next_state();
+
   /**
    *  Pick a context switch to take.
    *  Determines which thread to switch to now, according to whatever
@@ -332,6 +344,22 @@ public:
   /** Options that are enabled */
   optionst &options;
 
+  /**
+   *  Hook for parallel exploration.
+   *  When set, it's consulted each time backtracking finds an unexplored
+   *  context switch. It may fork a worker process, and returns like fork():
+   *  0 in the child, which then explores just the subtree below that switch;
+   *  positive in the parent, which skips that subtree and carries on with the
+   *  next switch; and -1 if no worker was started.
+   */
+  std::function<int()> fork_worker;
+
+  /**
+   *  Set of state hashes we've discovered, with --state-hashing. May be
+   *  replaced by a shared set when exploring with several worker processes.
+   */
+  std::shared_ptr<state_hash_sett> hit_hashes;
+
 protected:
   /** Stack of execution states representing current interleaving.
    *  See reachability_treet algorithm for how this is used. Is initialized
@@ -361,8 +389,6 @@ protected:
   unsigned int next_thread_id;
   /** Whether partial-order-reduction is enabled */
   bool por;
-  /** Set of state hashes we've discovered */
-  std::set<crypto_hash>hit_hashes;
   /** Message handler reference. */
   message_handlert &message_handler;
   /** Flag as to whether we're picking interleaving directions explicitly.
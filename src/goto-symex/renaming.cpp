@@ -280,7 +280,9 @@ renaming::level2t::make_assignment(expr2tc &lhs_symbol,
 {
   assert(to_symbol2t(lhs_symbol).rlevel == symbol2t::level1 ||
          to_symbol2t(lhs_symbol).rlevel == symbol2t::level1_global);
-  valuet &entry = current_names[name_record(to_symbol2t(lhs_symbol))];
+  name_record rec(to_symbol2t(lhs_symbol));
+  write_log.record(rec);
+  valuet &entry = current_names[rec];
 
   // This'll update entry beneath our feet; could reengineer it in the future.
   rename(lhs_symbol, entry.count + 1);
@@ -8,6 +8,7 @@
 #include <util/guard.h>
 #include <util/i2string.h>
 #include <util/irep2_expr.h>
+#include <util/persistent_map.h>
 #include <util/std_expr.h>
 
 namespace renaming {
@@ -221,12 +222,13 @@ namespace renaming {
 
     void remove(const expr2tc &symbol) override 
     {
-        current_names.erase(name_record(to_symbol2t(symbol)));
+      remove(name_record(to_symbol2t(symbol)));
     }
 
     void remove(const name_record &rec)
     {
-      current_names.erase(rec);
+      if (current_names.erase(rec))
+        write_log.record(rec);
     }
 
     void get_original_name(expr2tc &expr) const override 
@@ -254,6 +256,66 @@ namespace renaming {
       }
     }
 
+    // Names written (assigned or removed) so far, in order, so that merging
+    // a state forked off at some position only needs to look at the names
+    // written since. Positions are absolute and keep counting across
+    // forget(); a copy starts out with nothing logged, at the position the
+    // original had reached, as what the original logged isn't its history.
+    class write_logt
+    {
+    public:
+      write_logt() : base(0) { }
+      write_logt(const write_logt &ref) : base(ref.position()) { }
+
+      write_logt &operator=(const write_logt &ref)
+      {
+        base = ref.position();
+        names.clear();
+        return *this;
+      }
+
+      size_t position() const { return base + names.size(); }
+
+      void record(const name_record &rec) { names.push_back(rec); }
+
+      // Drop everything logged so far
+      void forget()
+      {
+        base = position();
+        names.clear();
+      }
+
+      // Add the names written since pos to vars; false if some of those
+      // writes are no longer in the log.
+      bool written_since(size_t pos, std::set<name_record> &vars) const
+      {
+        if (pos < base)
+          return false;
+
+        for (size_t i = pos - base; i < names.size(); i++)
+          vars.insert(names[i]);
+        return true;
+      }
+
+    protected:
+      size_t base;
+      std::vector<name_record> names;
+    };
+
+    write_logt write_log;
+
+    // Only the variables whose record differs from that in ref. Records the
+    // two still share, because one level2t was cloned from the other, are
+    // skipped without being looked at.
+    void get_diff_variables(const level2t &ref,
+                            std::set<name_record> &vars) const
+    {
+      current_names.diff(ref.current_names,
+        [&vars](const name_record &rec, const valuet *, const valuet *) {
+          vars.insert(rec);
+        });
+    }
+
     unsigned current_number(const expr2tc &sym) const;
     unsigned current_number(const name_record &rec) const;
 
@@ -274,7 +336,9 @@ namespace renaming {
 
     friend void build_goto_symex_classes();
     // Repeat of the above ignored friend directive.
-    typedef hash_map_cont<name_record, valuet, name_rec_hash> current_namest;
+    // Persistent, so that cloning a level2t for a branch is O(1) and only the
+    // records written afterwards get copied.
+    typedef persistent_mapt<name_record, valuet, name_rec_hash> current_namest;
 
     current_namest current_names;
     typedef std::map<const expr2tc, crypto_hash> current_state_hashest;
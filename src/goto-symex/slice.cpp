@@ -23,7 +23,7 @@ void symex_slicet::get_symbols(const expr2tc &expr)
 
   if (is_symbol2t(expr)) {
     const symbol2t &tmp = to_symbol2t(expr);
-    depends.insert(tmp.get_symbol_name());
+    depends.insert(symbol_ssa_idt(tmp));
   }
 }
 
@@ -54,6 +54,11 @@ void symex_slicet::slice_for_symbols(
 
 void symex_slicet::slice(symex_target_equationt::SSA_stept &SSA_step)
 {
+  // Steps that were already discarded (e.g. the assertions that aren't being
+  // checked in a multi-property run) contribute no dependencies.
+  if (SSA_step.ignore)
+    return;
+
   if (!single_slice)
     get_symbols(SSA_step.guard);
 
@@ -91,7 +96,7 @@ void symex_slicet::slice_assignment(
   assert(is_symbol2t(SSA_step.lhs));
 
   const symbol2t &tmp = to_symbol2t(SSA_step.lhs);
-  if (depends.find(tmp.get_symbol_name()) == depends.end())
+  if (depends.find(symbol_ssa_idt(tmp)) == depends.end())
   {
     // we don't really need it
     SSA_step.ignore=true;
@@ -102,7 +107,7 @@ void symex_slicet::slice_assignment(
     get_symbols(SSA_step.rhs);
     // Remove this symbol as we won't be seeing any references to it further
     // into the history.
-    depends.erase(tmp.get_symbol_name());
+    depends.erase(symbol_ssa_idt(tmp));
   }
 }
 
@@ -111,7 +116,7 @@ void symex_slicet::slice_renumber(
 {
   assert(is_symbol2t(SSA_step.lhs));
 
-  if (depends.find(to_symbol2t(SSA_step.lhs).get_symbol_name())
+  if (depends.find(symbol_ssa_idt(to_symbol2t(SSA_step.lhs)))
               == depends.end())
   {
     // we don't really need it
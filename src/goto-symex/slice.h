@@ -28,7 +28,7 @@ public:
   u_int64_t ignored;
 
 protected:
-  typedef hash_set_cont<std::string, string_hash> symbol_sett;
+  typedef hash_set_cont<symbol_ssa_idt, symbol_ssa_id_hash> symbol_sett;
 
   symbol_sett depends;
   bool single_slice;
@@ -0,0 +1,280 @@
+/*******************************************************************\
+
+Module: Compact set of execution state hashes
+
+\*******************************************************************/
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <goto-symex/state_hash_set.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+// How far a probe sequence may run in a shared set before giving up
+#define STATE_HASH_MAX_PROBE 256
+
+#define DIGEST_SIZE (5 * sizeof(unsigned int))
+
+state_hash_sett::state_hash_sett(
+  unsigned int log2_slots,
+  bool _shared,
+  const std::string &_spill_file)
+  : shared(_shared),
+    spill_fd(-1),
+    spill_file(_spill_file)
+{
+  map_table(log2_slots);
+
+#ifndef _WIN32
+  if (!shared && !spill_file.empty()) {
+    spill_fd = open(spill_file.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+    if (spill_fd < 0)
+      throw "Couldn't open state hash spill file " + spill_file;
+  }
+#endif
+}
+
+state_hash_sett::~state_hash_sett()
+{
+  unmap_table();
+
+#ifndef _WIN32
+  if (spill_fd >= 0) {
+    close(spill_fd);
+    unlink(spill_file.c_str());
+  }
+#endif
+}
+
+void state_hash_sett::map_table(unsigned int log2_slots)
+{
+  mask = (size_t(1) << log2_slots) - 1;
+  mapped_size = sizeof(headert) + (sizeof(slott) << log2_slots);
+
+  void *mem;
+#ifndef _WIN32
+  // Pages are only touched as slots get used, so a generous size is cheap
+  int flags = MAP_ANONYMOUS | MAP_NORESERVE;
+  flags |= (shared) ? MAP_SHARED : MAP_PRIVATE;
+  mem = mmap(nullptr, mapped_size, PROT_READ | PROT_WRITE, flags, -1, 0);
+  if (mem == MAP_FAILED)
+    throw "Couldn't map state hash table";
+#else
+  mem = calloc(1, mapped_size);
+  if (mem == nullptr)
+    throw "Couldn't allocate state hash table";
+#endif
+
+  header = static_cast<headert *>(mem);
+  slots = reinterpret_cast<slott *>(header + 1);
+}
+
+void state_hash_sett::unmap_table()
+{
+#ifndef _WIN32
+  munmap(header, mapped_size);
+#else
+  free(header);
+#endif
+}
+
+bool state_hash_sett::probe(const unsigned int *digest, bool insert)
+{
+  size_t limit = (shared) ? STATE_HASH_MAX_PROBE : mask + 1;
+  size_t idx = digest[0] & mask;
+
+  for (size_t n = 0; n < limit; n++) {
+    slott &slot = slots[(idx + n) & mask];
+
+    if (insert && slot.state == slot_empty &&
+        __sync_bool_compare_and_swap(&slot.state, slot_empty, slot_writing)) {
+      memcpy(slot.digest, digest, DIGEST_SIZE);
+      __sync_synchronize();
+      slot.state = slot_full;
+      __sync_fetch_and_add(&header->entries, 1);
+      __sync_fetch_and_add(&header->probes, n + 1);
+      return false;
+    }
+
+    uint32_t state;
+    while ((state = slot.state) == slot_writing) {
+#ifndef _WIN32
+      sched_yield();
+#endif
+    }
+
+    if (state == slot_empty) {
+      // Lost the race for this slot to another process; look again
+      if (insert) {
+        n--;
+        continue;
+      }
+      __sync_fetch_and_add(&header->probes, n + 1);
+      return false;
+    }
+
+    __sync_synchronize();
+    if (memcmp(slot.digest, digest, DIGEST_SIZE) == 0) {
+      __sync_fetch_and_add(&header->probes, n + 1);
+      return true;
+    }
+  }
+
+  __sync_fetch_and_add(&header->probes, limit);
+  if (insert)
+    __sync_fetch_and_add(&header->dropped, 1);
+  return false;
+}
+
+bool state_hash_sett::contains(const crypto_hash &hash)
+{
+  __sync_fetch_and_add(&header->lookups, 1);
+
+  bool found = probe(hash.hash, false) || spilled_contains(hash.hash);
+  if (found)
+    __sync_fetch_and_add(&header->hits, 1);
+
+  return found;
+}
+
+void state_hash_sett::insert(const crypto_hash &hash)
+{
+  __sync_fetch_and_add(&header->inserts, 1);
+
+  if (spilled_contains(hash.hash))
+    return;
+
+  if (!shared && header->entries >= (mask + 1) / 4 * 3) {
+    if (spill_fd >= 0)
+      spill();
+    else
+      grow();
+  }
+
+  probe(hash.hash, true);
+}
+
+void state_hash_sett::grow()
+{
+  headert *old_header = header;
+  slott *old_slots = slots;
+  size_t old_mask = mask;
+  size_t old_size = mapped_size;
+
+  unsigned int log2_slots = 0;
+  while ((size_t(1) << log2_slots) <= old_mask)
+    log2_slots++;
+  map_table(log2_slots + 1);
+
+  headert counters = *old_header;
+  counters.entries = 0;
+  *header = counters;
+
+  for (size_t idx = 0; idx <= old_mask; idx++)
+    if (old_slots[idx].state == slot_full)
+      probe(old_slots[idx].digest, true);
+
+  // Rehashing isn't lookup work
+  header->probes = old_header->probes;
+
+#ifndef _WIN32
+  munmap(old_header, old_size);
+#else
+  (void)old_size;
+  free(old_header);
+#endif
+}
+
+void state_hash_sett::spill()
+{
+#ifndef _WIN32
+  std::vector<unsigned int> run;
+  run.reserve(header->entries * 5);
+
+  std::vector<size_t> order;
+  for (size_t idx = 0; idx <= mask; idx++) {
+    if (slots[idx].state != slot_full)
+      continue;
+    order.push_back(idx);
+  }
+
+  std::sort(order.begin(), order.end(), [this](size_t a, size_t b) {
+    return memcmp(slots[a].digest, slots[b].digest, DIGEST_SIZE) < 0;
+  });
+
+  for (size_t idx : order)
+    run.insert(run.end(), slots[idx].digest, slots[idx].digest + 5);
+
+  off_t offset = lseek(spill_fd, 0, SEEK_END);
+  const char *buf = reinterpret_cast<const char *>(run.data());
+  size_t len = run.size() * sizeof(unsigned int);
+  while (len > 0) {
+    ssize_t written = pwrite(spill_fd, buf, len, offset);
+    if (written <= 0)
+      throw "Couldn't write state hash spill file " + spill_file;
+    buf += written;
+    len -= written;
+    offset += written;
+  }
+
+  runs.emplace_back(offset - run.size() * sizeof(unsigned int), order.size());
+  header->spilled += order.size();
+
+  memset(slots, 0, (mask + 1) * sizeof(slott));
+  header->entries = 0;
+#endif
+}
+
+bool state_hash_sett::spilled_contains(const unsigned int *digest) const
+{
+#ifndef _WIN32
+  for (auto const &run : runs) {
+    size_t lo = 0, hi = run.second;
+    while (lo < hi) {
+      size_t mid = lo + (hi - lo) / 2;
+      unsigned int entry[5];
+      if (pread(spill_fd, entry, DIGEST_SIZE, run.first + mid * DIGEST_SIZE)
+          != (ssize_t)DIGEST_SIZE)
+        break;
+
+      int cmp = memcmp(entry, digest, DIGEST_SIZE);
+      if (cmp == 0)
+        return true;
+      if (cmp < 0)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+  }
+#else
+  (void)digest;
+#endif
+
+  return false;
+}
+
+void state_hash_sett::output_stats(std::ostream &out) const
+{
+  out << "State hashes: " << header->entries << " in memory";
+  if (spill_fd >= 0)
+    out << ", " << header->spilled << " spilled in " << runs.size()
+        << " run(s)";
+  out << ", " << (mask + 1) << " slots (" << mapped_size << " bytes)\n";
+  out << "State hash lookups: " << header->lookups << ", hits: "
+      << header->hits << ", inserts: " << header->inserts;
+  if (header->dropped)
+    out << ", dropped: " << header->dropped;
+  out << ", mean probe length: ";
+  uint64_t ops = header->lookups + header->inserts;
+  if (ops)
+    out << (double)header->probes / ops;
+  else
+    out << 0;
+  out << "\n";
+}
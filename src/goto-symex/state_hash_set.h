@@ -0,0 +1,97 @@
+/*******************************************************************\
+
+Module: Compact set of execution state hashes
+
+\*******************************************************************/
+
+#ifndef CPROVER_GOTO_SYMEX_STATE_HASH_SET_H
+#define CPROVER_GOTO_SYMEX_STATE_HASH_SET_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <sys/types.h>
+#include <util/crypto_hash.h>
+#include <vector>
+
+/**
+ *  Open-addressing set of crypto_hash digests, as used by --state-hashing.
+ *  Each entry is the bare 20 byte digest plus a state word, rather than a
+ *  whole crypto_hash with its hashing context.
+ *
+ *  A shared set lives in an anonymous shared mapping, so that processes
+ *  forked after its creation see each other's insertions. Slots are claimed
+ *  with a compare-and-swap on their state word before the digest is written,
+ *  and readers that meet a slot being written wait for it. A shared set
+ *  can't be resized: once full, further inserts are dropped, which only
+ *  costs some pruning.
+ *
+ *  A private set doubles whenever it becomes three quarters full; unless it
+ *  was given a spill file, in which case its contents are instead appended
+ *  to that file as a sorted run, and looked up there by binary search after
+ *  missing in memory.
+ */
+class state_hash_sett
+{
+public:
+  state_hash_sett(
+    unsigned int log2_slots,
+    bool shared,
+    const std::string &spill_file = "");
+  ~state_hash_sett();
+
+  state_hash_sett(const state_hash_sett &ref) = delete;
+  state_hash_sett &operator=(const state_hash_sett &ref) = delete;
+
+  bool contains(const crypto_hash &hash);
+  void insert(const crypto_hash &hash);
+
+  /** Print the usage counters, for --memstats */
+  void output_stats(std::ostream &out) const;
+
+protected:
+  enum { slot_empty = 0, slot_writing, slot_full };
+
+  struct slott
+  {
+    volatile uint32_t state;
+    unsigned int digest[5];
+  };
+
+  // Lives at the start of the mapping, so that counters are shared too
+  struct headert
+  {
+    volatile uint64_t entries;
+    volatile uint64_t lookups;
+    volatile uint64_t hits;
+    volatile uint64_t inserts;
+    volatile uint64_t probes;
+    volatile uint64_t dropped;
+    volatile uint64_t spilled;
+  };
+
+  headert *header;
+  slott *slots;
+  size_t mask;
+  size_t mapped_size;
+  bool shared;
+
+  int spill_fd;
+  std::string spill_file;
+  // Offset and length (in digests) of each sorted run in the spill file
+  std::vector<std::pair<off_t, size_t> > runs;
+
+  void map_table(unsigned int log2_slots);
+  void unmap_table();
+
+  // Look for digest in memory, claiming an empty slot for it if insert is
+  // set. Returns true if it was already present.
+  bool probe(const unsigned int *digest, bool insert);
+
+  void grow();
+  void spill();
+  bool spilled_contains(const unsigned int *digest) const;
+};
+
+#endif
@@ -15,11 +15,13 @@
 #include <iostream>
 #include <langapi/language_ui.h>
 #include <solvers/smtlib/smtlib_conv.h>
+#include <sstream>
 #include <util/expr_util.h>
 #include <util/irep2.h>
 #include <util/migrate.h>
 #include <util/prefix.h>
 #include <util/std_expr.h>
+#include <util/time_stopping.h>
 
 void
 goto_symext::symex_goto(const expr2tc &old_guard)
@@ -55,12 +57,13 @@ goto_symext::symex_goto(const expr2tc &old_guard)
     }
   }
 
-  goto_programt::const_targett goto_target =
-    instruction.targets.front();
+  // Branch target and direction come from the program's flat view, rather
+  // than chasing the targets list of the instruction.
+  const goto_programt &prog = *cur_state->source.prog;
+  const goto_programt::flat_instructiont &flat =
+    prog.flat_instruction(cur_state->source.pc);
 
-  bool forward =
-    cur_state->source.pc->location_number <
-    goto_target->location_number;
+  bool forward = !flat.backwards;
 
   // Check if we are inside a loop, during inductive step
   if(inductive_step && (instruction.loop_number != 0))
@@ -80,8 +83,8 @@ goto_symext::symex_goto(const expr2tc &old_guard)
   if (new_guard_false)
   {
     // reset unwinding counter
-    if(instruction.is_backwards_goto())
-      frame.loop_iterations[instruction.loop_number] = 0;
+    if(flat.backwards)
+      frame.loop_iterations[flat.loop_number] = 0;
 
     // next instruction
     cur_state->source.pc++;
@@ -95,10 +98,12 @@ goto_symext::symex_goto(const expr2tc &old_guard)
   if (instruction.targets.size() != 1)
     throw "no support for non-deterministic gotos";
 
+  goto_programt::const_targett goto_target = prog.flat()[flat.target].it;
+
   // backwards?
   if (!forward)
   {
-    BigInt &unwind = frame.loop_iterations[instruction.loop_number];
+    BigInt &unwind = frame.loop_iterations[flat.loop_number];
     ++unwind;
 
     if (get_unwind(cur_state->source, unwind)) {
@@ -187,6 +192,10 @@ goto_symext::merge_gotos()
 {
   statet::framet &frame = cur_state->top();
 
+  // Called on every step; most of the time there is nothing pending at all
+  if (frame.goto_state_map.empty())
+    return;
+
   // first, see if this is a target at all
   statet::goto_state_mapt::iterator state_map_it =
     frame.goto_state_map.find(cur_state->source.pc);
@@ -197,6 +206,13 @@ goto_symext::merge_gotos()
   // we need to merge
   statet::goto_state_listt &state_list = state_map_it->second;
 
+  bool merge_stats = options.get_bool_option("merge-stats");
+  fine_timet merge_start;
+  if (merge_stats)
+    merge_start = current_time();
+
+  unsigned int num_states = state_list.size(), num_phis = 0;
+
   for (statet::goto_state_listt::reverse_iterator
        list_it = state_list.rbegin();
        list_it != state_list.rend();
@@ -205,7 +221,7 @@ goto_symext::merge_gotos()
     statet::goto_statet &goto_state = *list_it;
 
     // do SSA phi functions
-    phi_function(goto_state);
+    num_phis += phi_function(goto_state);
 
     merge_value_sets(goto_state);
 
@@ -218,6 +234,25 @@ goto_symext::merge_gotos()
 
   // clean up to save some memory
   frame.goto_state_map.erase(state_map_it);
+
+  // With nothing left to merge in this thread, nobody needs the writes
+  // logged so far. States pending in other threads, which share our level2,
+  // fall back to comparing their records.
+  bool pending = false;
+  for (const auto &f : cur_state->call_stack)
+    pending |= !f.goto_state_map.empty();
+  if (!pending)
+    cur_state->level2.write_log.forget();
+
+  if (merge_stats)
+  {
+    std::ostringstream str;
+    str << "Merge at " << cur_state->source.pc->location.as_string() << ": "
+        << num_states << " state(s), " << num_phis << " phi assignment(s), ";
+    output_time(current_time() - merge_start, str);
+    str << "s";
+    std::cout << str.str() << std::endl;
+  }
 }
 
 void
@@ -231,14 +266,19 @@ goto_symext::merge_value_sets(const statet::goto_statet &src)
   cur_state->value_set.make_union(src.value_set);
 }
 
-void
+unsigned int
 goto_symext::phi_function(const statet::goto_statet &goto_state)
 {
-  // go over all variables to see what changed
+  // go over the variables written since goto_state was forked off; those
+  // are the only ones that can differ. If the log no longer reaches back
+  // that far, compare the records that the two level2s don't share.
   std::set<renaming::level2t::name_record> variables;
 
-  goto_state.level2.get_variables(variables);
-  cur_state->level2.get_variables(variables);
+  if (!cur_state->level2.write_log.written_since(
+        goto_state.level2_log_pos, variables))
+    goto_state.level2.get_diff_variables(cur_state->level2, variables);
+
+  unsigned int num_phis = 0;
 
   guardt tmp_guard;
   if(!variables.empty()
@@ -312,7 +352,11 @@ goto_symext::phi_function(const statet::goto_statet &goto_state)
       cur_state->source,
       cur_state->gen_stack_trace(),
       symex_targett::HIDDEN);
+
+    num_phis++;
   }
+
+  return num_phis;
 }
 
 void
@@ -23,22 +23,11 @@ class dummy_renaming_class {};
 // provides a contains() method that it doesn't (appear to) use itself.
 // This means that you can use the 'in' operator on the vector from python.
 // However that doesn't semantically make sense (why would you search for a
-// goto_symex_statet...), so I don't see a point in implementing it. Therefore
-// abort if someone tries to do that from python.
+// framet...), so I don't see a point in implementing it. Therefore abort if
+// someone tries to do that from python.
 // One could throw, but I think abort gets the nuances of the point across
 // better.
 bool
-operator==(const goto_symex_statet &a, const goto_symex_statet &b)
-{
-  (void)a;
-  (void)b;
-  std::cerr << "Something called contains() or similar on a boost python "
-    "vector of goto_symex_statet's: don't do that." << std::endl;
-  abort();
-}
-
-// Also: framet.
-bool
 operator==(const goto_symex_statet::framet &a, const goto_symex_statet::framet &b)
 {
   (void)a;
@@ -382,8 +371,7 @@ build_goto_symex_classes()
      .def_readwrite("t_num", &level2t::name_record::t_num)
      .def_readwrite("hash", &level2t::name_record::hash);
 
-    class_<level2t::current_namest>("level2_current_names")
-      .def(map_indexing_suite<level2t::current_namest, true>());
+    export_persistent_map<level2t::current_namest>("level2_current_names");
   }
 
   // Overload resolve...
@@ -603,6 +591,8 @@ build_goto_symex_classes()
     .def("has_cswitch_point_occured", &execution_statet::has_cswitch_point_occured)
     .def("can_execution_continue", &execution_statet::can_execution_continue)
     .def("print_stack_traces", &execution_statet::print_stack_traces)
+    .def("get_thread_state", &execution_statet::get_thread_state, return_internal_reference<>())
+    .def("get_mutable_thread_state", &execution_statet::get_mutable_thread_state, return_internal_reference<>())
     .def_readwrite("owning_rt", &execution_statet::owning_rt)
     .def_readwrite("threads_state", &execution_statet::threads_state)
     .def_readwrite("atomic_numbers", &execution_statet::atomic_numbers)
@@ -635,10 +625,11 @@ build_goto_symex_classes()
     .def_readwrite("smt_thread_guard", &execution_statet::smt_thread_guard)
     .def_readwrite("node_count", &execution_statet::node_count);
 
-  // NB: this requires an operator== to be defined for goto_symex_statet,
-  // see above.
-  class_<std::vector<goto_symex_statet> >("goto_symex_statet_vec")
-    .def(vector_indexing_suite<std::vector<goto_symex_statet> >());
+  // Thread states are shared between ex_states; writes through these skip the
+  // copy that get_mutable_thread_state makes.
+  register_ptr_to_python<boost::shared_ptr<goto_symex_statet> >();
+  class_<std::vector<boost::shared_ptr<goto_symex_statet> > >("goto_symex_statet_vec")
+    .def(vector_indexing_suite<std::vector<boost::shared_ptr<goto_symex_statet> >, true>());
   class_<std::vector<unsigned int> >("atomic_nums_vec")
     .def(vector_indexing_suite<std::vector<unsigned> >());
   class_<std::vector<bool> >("dfs_state_vec")
@@ -299,7 +299,7 @@ std::ostream &operator<<(
 void
 symex_target_equationt::check_for_duplicate_assigns() const
 {
-  std::map<std::string, unsigned int> countmap;
+  std::map<symbol_ssa_idt, unsigned int> countmap;
   unsigned int i = 0;
 
   for (const auto & SSA_step : SSA_steps) {
@@ -309,14 +309,15 @@ symex_target_equationt::check_for_duplicate_assigns() const
 
     const equality2t &ref = to_equality2t(SSA_step.cond);
     const symbol2t &sym = to_symbol2t(ref.side_1);
-    countmap[sym.get_symbol_name()]++;
+    countmap[symbol_ssa_idt(sym)]++;
   }
 
-  for (std::map<std::string, unsigned int>::const_iterator it =countmap.begin();
+  for (std::map<symbol_ssa_idt, unsigned int>::const_iterator it =
+         countmap.begin();
        it != countmap.end(); it++) {
     if (it->second != 1) {
-      std::cerr << "Symbol \"" << it->first << "\" appears " << it->second
-                << " times" << std::endl;
+      std::cerr << "Symbol \"" << it->first.as_string() << "\" appears "
+                << it->second << " times" << std::endl;
     }
   }
 
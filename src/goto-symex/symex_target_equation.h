@@ -22,6 +22,7 @@ Author: Daniel Kroening, kroening@kroening.com
 #include <util/config.h>
 #include <util/irep2.h>
 #include <util/namespace.h>
+#include <util/pool_allocator.h>
 #include <vector>
 
 class symex_target_equationt:public symex_targett
@@ -138,7 +139,9 @@ public:
     return i;
   }
 
-  typedef std::list<SSA_stept> SSA_stepst;
+  // Steps of one equation, and of every equation cloned from it, come from a
+  // shared node pool; see pool_allocatort.
+  typedef std::list<SSA_stept, pool_allocatort<SSA_stept> > SSA_stepst;
   SSA_stepst SSA_steps;
 
   SSA_stepst::iterator get_SSA_step(unsigned s)
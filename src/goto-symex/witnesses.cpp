@@ -16,56 +16,88 @@
 #include <langapi/languages.h>
 #include <util/irep2.h>
 
-int generate_sha1_hash_for_file(const char * path, std::string & output)
+std::string read_file(const std::string& path)
 {
-  FILE * file = fopen(path, "rb");
-  if(!file)
-    return -1;
-
-  const int bufSize = 32768;
-  char * buffer = (char *) alloca(bufSize);
+  std::ifstream t(path.c_str());
+  std::string str((std::istreambuf_iterator<char>(t)),
+      std::istreambuf_iterator<char>());
+  return str;
+}
 
-  crypto_hash c;
-  int bytesRead = 0;
-  while((bytesRead = fread(buffer, 1, bufSize, file)))
-    c.ingest(buffer, bytesRead);
+/* Line offsets of a source file, built with a single pass over its
+ * contents the first time any node or edge of the witness refers to it */
+class line_indext
+{
+public:
+  explicit line_indext(const std::string& path)
+  {
+    std::ifstream file(path.c_str(), std::ios::binary);
+    valid = file.is_open();
+    if (!valid)
+      return;
 
-  c.fin();
-  output = c.to_string();
+    contents.assign((std::istreambuf_iterator<char>(file)),
+      std::istreambuf_iterator<char>());
 
-  fclose(file);
-  return 0;
-}
+    if (!contents.empty())
+      line_starts.push_back(0);
+    for (size_t i = 0; i < contents.size(); i++)
+      if (contents[i] == '\n' && i + 1 < contents.size())
+        line_starts.push_back(i + 1);
+  }
 
-int node_count;
-int edge_count;
+  /* number of characters in the first n lines, as `head -n n | wc --chars` */
+  size_t end_of_line(int n) const
+  {
+    if (n <= 0)
+      return 0;
+    if ((size_t) n >= line_starts.size())
+      return contents.size();
+    return line_starts[n];
+  }
 
-std::string execute_cmd(const std::string& command)
-{
-  /* add ./ for linux execution */
-  std::string initial = command.substr(0, 1);
-  FILE* pipe = popen(command.c_str(), "r");
-  if (!pipe)
-    return "ERROR";
-  char buffer[128];
-  std::string result;
-  while (!feof(pipe))
+  /* spaces at the start of line n, or of the last line if n is past it */
+  unsigned int leading_spaces(int n) const
   {
-    if (fgets(buffer, 128, pipe) != nullptr)
-      result += buffer;
+    if (n <= 0 || line_starts.empty())
+      return 0;
+    size_t i = line_starts[std::min((size_t) n, line_starts.size()) - 1];
+    unsigned int spaces = 0;
+    for (; i < contents.size() && contents[i] == ' '; i++)
+      spaces++;
+    return spaces;
   }
-  pclose(pipe);
-  return result;
+
+  bool valid;
+  std::string contents;
+  std::vector<size_t> line_starts;
+};
+
+static const line_indext& get_line_index(const std::string& path)
+{
+  static std::map<std::string, std::unique_ptr<line_indext> > indexes;
+  std::unique_ptr<line_indext>& index = indexes[path];
+  if (!index)
+    index.reset(new line_indext(path));
+  return *index;
 }
 
-std::string read_file(const std::string& path)
+int generate_sha1_hash_for_file(const char * path, std::string & output)
 {
-  std::ifstream t(path.c_str());
-  std::string str((std::istreambuf_iterator<char>(t)),
-      std::istreambuf_iterator<char>());
-  return str;
+  const line_indext& index = get_line_index(path);
+  if (!index.valid)
+    return -1;
+
+  crypto_hash c;
+  c.ingest(index.contents.data(), index.contents.size());
+  c.fin();
+  output = c.to_string();
+  return 0;
 }
 
+int node_count;
+int edge_count;
+
 std::string trim(const std::string& str)
 {
   const std::string whitespace_characters = " \t\r\n";
@@ -80,13 +112,12 @@ std::string trim(const std::string& str)
 void map_line_number_to_content(const std::string& source_code_file,
     std::map<int, std::string> & line_content_map)
 {
-  std::ifstream sfile(source_code_file);
-  if (!sfile)
+  const line_indext& index = get_line_index(source_code_file);
+  if (!index.valid)
   {
     return;
   }
-  std::string source_content = read_file(source_code_file);
-  std::istringstream source_stream(source_content);
+  std::istringstream source_stream(index.contents);
   std::string line;
   int line_count = 0;
   while (std::getline(source_stream, line))
@@ -612,35 +643,18 @@ std::string w_string_replace(
   return subject;
 }
 
-void get_offsets_for_line_using_wc(
+void get_offsets_for_line(
   const std::string & file_path,
   const int line_number,
   int & p_startoffset,
   int & p_endoffset)
 {
-  unsigned int startoffset = 0;
-  unsigned int endoffset = 0;
-
-  try {
-    /* get the offsets */
-    startoffset = std::atoi(execute_cmd("cat " + file_path + " | head -n " + std::to_string(line_number - 1) + " | wc --chars").c_str());
-    endoffset = std::atoi(execute_cmd("cat " + file_path + " | head -n " + std::to_string(line_number) + " | wc --chars").c_str());
-    /* count the spaces in the beginning and append to the startoffset  */
-    std::string str_line = execute_cmd("cat " + file_path + " | head -n " + std::to_string(line_number) + " | tail -n 1 ");
-    unsigned int i=0;
-    for (i=0; i<str_line.length(); i++)
-    {
-      if (str_line.c_str()[i] == ' ')
-        startoffset++;
-      else
-        break;
-    }
-  } catch (const std::exception& e) {
-    /* nothing to do here */
-  }
+  const line_indext& index = get_line_index(file_path);
 
-  p_startoffset = startoffset;
-  p_endoffset = endoffset;
+  /* the start offset skips the spaces at the beginning of the line */
+  p_startoffset =
+    index.end_of_line(line_number - 1) + index.leading_spaces(line_number);
+  p_endoffset = index.end_of_line(line_number);
 }
 
 bool is_valid_witness_expr(
@@ -75,7 +75,7 @@ std::string w_string_replace(
   const std::string & search,
   const std::string & replace);
 
-void get_offsets_for_line_using_wc(
+void get_offsets_for_line(
   const std::string & file_path,
   const int line_number,
   int & p_startoffset,
@@ -134,24 +134,35 @@ bool value_sett::make_union(const value_sett::valuest &new_values, bool keepnew)
 {
   bool result=false;
 
+  // Find the new values that differ from ours: entries the two sets still
+  // share can't add anything. Writing to values while walking it would
+  // unshare the very nodes being walked, so collect them first.
+  std::vector<std::pair<string_wrapper, const entryt *> > changed;
+  values.diff(new_values,
+    [&changed](const string_wrapper &name, const entryt *, const entryt *e) {
+      if(e != nullptr)
+        changed.emplace_back(name, e);
+    });
+
   // Iterate over all new values; if they're in the current value set, merge
   // them. If not, only merge it in if keepnew is true.
-  for(const auto & new_value : new_values)
+  for(const auto & new_value : changed)
   {
-    valuest::iterator it2=values.find(new_value.first);
+    entryt *e=values.get_mutable(new_value.first);
+    const entryt &new_e=*new_value.second;
 
     // If the new variable isnt in this' set,
-    if(it2==values.end())
+    if(e==nullptr)
     {
       // We always track these when merging value sets, as these store data
       // that's transfered back and forth between function calls. So, the
       // variables not existing in the state we're merging into is irrelevant.
-      if(has_prefix(id2string(new_value.second.identifier),
+      if(has_prefix(id2string(new_e.identifier),
            "value_set::dynamic_object") ||
-         new_value.second.identifier=="value_set::return_value" ||
+         new_e.identifier=="value_set::return_value" ||
          keepnew)
       {
-        values.insert(new_value);
+        values[new_value.first]=new_e;
         result=true;
       }
 
@@ -159,10 +170,7 @@ bool value_sett::make_union(const value_sett::valuest &new_values, bool keepnew)
     }
 
     // The variable was in this' set, merge the values.
-    entryt &e=it2->second;
-    const entryt &new_e=new_value.second;
-
-    if(make_union(e.object_map, new_e.object_map))
+    if(make_union(e->object_map, new_e.object_map))
       result=true;
   }
 
@@ -971,9 +979,10 @@ void value_sett::do_free(const expr2tc &op)
     }
   }
 
-  // mark these as 'may be invalid'
-  // this, unfortunately, destroys the sharing
-  for(auto & value : values)
+  // mark these as 'may be invalid'; only the entries that change are written
+  // back, so that the rest stay shared
+  std::vector<std::pair<string_wrapper, object_mapt> > changes;
+  for(const auto & value : values)
   {
     object_mapt new_object_map;
 
@@ -1008,8 +1017,11 @@ void value_sett::do_free(const expr2tc &op)
     }
 
     if(changed)
-      value.second.object_map=new_object_map;
+      changes.emplace_back(value.first, new_object_map);
   }
+
+  for(auto & change : changes)
+    values.get_mutable(change.first)->object_map.swap(change.second);
 }
 
 void value_sett::assign_rec(
@@ -1320,6 +1332,7 @@ value_sett::obj_numbering_deref(unsigned int num)
 #include <boost/python/suite/indexing/vector_indexing_suite.hpp>
 #include <boost/python/return_internal_reference.hpp>
 #include <boost/python/operators.hpp>
+#include <util/bp_converter.h>
 
 // Wrap call to get_value_set to just return a python list: otherwise we wind
 // up having the caller spuriously allocate a value_setst::valuest, which is
@@ -1388,8 +1401,7 @@ build_value_set_classes()
     .def_readwrite("values", &value_sett::values);
   // XXX object numberingt?
 
-  class_<value_sett::valuest>("valuest")
-    .def(map_indexing_suite<value_sett::valuest>());
+  export_persistent_map<value_sett::valuest>("valuest");
 
   class_<value_sett::objectt>("objectt", init<bool, unsigned int>())
     .def(init<bool, BigInt>())
@@ -15,6 +15,7 @@ Author: Daniel Kroening, kroening@kroening.com
 #include <util/mp_arith.h>
 #include <util/namespace.h>
 #include <util/numbering.h>
+#include <util/persistent_map.h>
 #include <util/type_byte_size.h>
 
 /** Code for tracking "value sets" across assignments in ESBMC.
@@ -244,8 +245,9 @@ public:
 
   /** Type of the value-set containing structure. A hash map mapping variables
    *  to an entryt, storing the value set of objects a variable might point
-   *  at. */
-  typedef hash_map_cont<string_wrapper, entryt, string_wrap_hash> valuest;
+   *  at. It's persistent: copying a value set at a branch shares every entry
+   *  until one side writes to it, and merging skips what is still shared. */
+  typedef persistent_mapt<string_wrapper, entryt, string_wrap_hash> valuest;
 
   /** Get the natural alignment unit of a reference to e. I don't know a more
    *  appropriate term, but if we were to have an offset into e, then what is
@@ -467,13 +469,15 @@ public:
    *  given entryt. */
   entryt &get_entry(const entryt &e)
   {
-    std::string index=id2string(e.identifier)+e.suffix;
+    string_wrapper index(id2string(e.identifier)+e.suffix);
 
-    std::pair<valuest::iterator, bool> r=
-      values.insert(std::pair<string_wrapper, entryt>
-                             (string_wrapper(index), e));
+    entryt *existing = values.get_mutable(index);
+    if(existing != nullptr)
+      return *existing;
 
-    return r.first->second;
+    entryt &r = values[index];
+    r = e;
+    return r;
   }
 
   /** Add a value set for each variable in the given list. */
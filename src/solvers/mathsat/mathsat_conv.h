@@ -78,6 +78,7 @@ public:
 
   void push_ctx() override;
   void pop_ctx() override;
+  bool supports_ctx() const override { return true; }
 
   expr2tc get_bool(const smt_ast *a) override;
   expr2tc get_bv(const type2tc &t, const smt_ast *a) override;
@@ -434,6 +434,10 @@ public:
   virtual void push_ctx();
   /** Pop one context on the SMT assertion stack. */
   virtual void pop_ctx();
+  /** Whether the underlying solver really retracts the assertions made since
+   *  the matching push_ctx when pop_ctx is called. Solvers that don't can
+   *  only be used for a single formula. */
+  virtual bool supports_ctx() const { return false; }
 
   /** Main interface to SMT conversion.
    *  Takes one expression, and converts it into the underlying SMT solver,
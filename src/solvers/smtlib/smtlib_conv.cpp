@@ -1,11 +1,16 @@
 // "Standards" workaround
 #define __STDC_FORMAT_MACROS
 
+#include <cerrno>
 #include <cinttypes>
+#include <csignal>
+#include <fcntl.h>
+#include <poll.h>
 #include <smtlib_conv.h>
 #include <smtlib.hpp>
 #include <smtlib_tok.hpp>
 #include <sstream>
+#include <sys/wait.h>
 #include <unistd.h>
 
 // Dec of external lexer input stream
@@ -55,6 +60,7 @@ smtlib_convt::smtlib_convt(bool int_encoding, const namespacet &_ns,
     solver_name = "Text output";
     solver_version = "";
     solver_proc_pid = 0;
+    tee_proc_pid = 0;
 
     fprintf(out_stream, "(set-logic %s)\n", logic.c_str());
     fprintf(out_stream, "(set-info :status unknown)\n");
@@ -63,11 +69,9 @@ smtlib_convt::smtlib_convt(bool int_encoding, const namespacet &_ns,
     return;
   }
 
-  // Setup: open a pipe to the smtlib solver. There seems to be no standard C++
+  // Setup: open pipes to the smtlib solvers. There seems to be no standard C++
   // way of opening a stream from an fd, so use C file streams.
 
-  int inpipe[2], outpipe[2];
-
   cmd = options.get_option("smtlib-solver-prog");
   if (cmd == "") {
     std::cerr << "Must specify an smtlib solver program in smtlib mode"
@@ -75,6 +79,104 @@ smtlib_convt::smtlib_convt(bool int_encoding, const namespacet &_ns,
     abort();
   }
 
+  // Several programs may be given, separated by commas: all of them are fed
+  // the same formula, and the first to answer check-sat wins.
+  std::vector<int> solver_fds;
+  std::string::size_type start = 0;
+  do {
+    std::string::size_type end = cmd.find(',', start);
+    if (end == std::string::npos)
+      end = cmd.size();
+
+    struct solver_proct proc;
+    solver_fds.push_back(start_solver(cmd.substr(start, end - start), proc));
+    solvers.push_back(proc);
+    start = end + 1;
+  } while (start <= cmd.size());
+
+  if (solvers.size() == 1) {
+    out_stream = fdopen(solver_fds.front(), "w");
+    tee_proc_pid = 0;
+  } else {
+    out_stream = fdopen(start_tee(solver_fds), "w");
+  }
+
+  solver_proc_pid = solvers.front().pid;
+  in_stream = solvers.front().in_stream;
+
+  // Execution continues as the parent ESBMC process. Child dying will
+  // trigger SIGPIPE or an EOF eventually, which we'll be able to detect
+  // and crash upon.
+
+  fprintf(out_stream, "(set-logic %s)\n", logic.c_str());
+  fprintf(out_stream, "(set-info :status unknown)\n");
+  fprintf(out_stream, "(set-option :produce-models true)\n");
+
+  // Fetch solver names and versions. Every solver sees both queries, and
+  // answers them in order on its own output.
+  fprintf(out_stream, "(get-info :name)\n");
+  fprintf(out_stream, "(get-info :version)\n");
+  fflush(out_stream);
+
+  for (const struct solver_proct &proc : solvers) {
+    // Point lexer input at this solver's output stream
+    smtlib_tokrestart(proc.in_stream);
+
+    smtlib_send_start_code = 1;
+    smtlibparse(TOK_START_INFO);
+
+    // As a result we should have a single entry in a list of sexprs.
+    class sexpr *sexpr = smtlib_output;
+    assert(sexpr->sexpr_list.size() == 1 &&
+           "More than one sexpr response to get-info name");
+    class sexpr &s = sexpr->sexpr_list.front();
+
+    // Should have a keyword followed by a string?
+    assert(s.token == 0 && s.sexpr_list.size() == 2 &&
+           "Bad solver name format");
+    class sexpr &keyword = s.sexpr_list.front();
+    class sexpr &value = s.sexpr_list.back();
+    assert(keyword.token == TOK_KEYWORD && keyword.data == ":name" &&
+           "Bad get-info :name response from solver");
+    assert(value.token == TOK_STRINGLIT && "Non-string solver name response");
+    std::string name = value.data;
+    delete smtlib_output;
+
+    // Duplicate / boilerplate;
+    smtlib_send_start_code = 1;
+    smtlibparse(TOK_START_INFO);
+
+    sexpr = smtlib_output;
+    assert(sexpr->sexpr_list.size() == 1 &&
+           "More than one sexpr response to get-info version");
+    class sexpr &v = sexpr->sexpr_list.front();
+
+    assert(v.token == 0 && v.sexpr_list.size() == 2 &&
+           "Bad solver version fmt");
+    class sexpr &kw = v.sexpr_list.front();
+    class sexpr &val = v.sexpr_list.back();
+    assert(kw.token == TOK_KEYWORD && kw.data == ":version" &&
+           "Bad get-info :version response from solver");
+    assert(val.token == TOK_STRINGLIT && "Non-string solver version response");
+    std::string version = val.data;
+    delete smtlib_output;
+
+    if (&proc == &solvers.front()) {
+      solver_name = name;
+      solver_version = version;
+    } else {
+      solver_version += ", " + name + " version " + version;
+    }
+  }
+
+  smtlib_tokrestart(in_stream);
+}
+
+int
+smtlib_convt::start_solver(const std::string &prog, struct solver_proct &proc)
+{
+  int inpipe[2], outpipe[2];
+
   if (pipe(inpipe) != 0) {
     std::cerr << "Couldn't open a pipe for smtlib solver" << std::endl;
     abort();
@@ -85,8 +187,13 @@ smtlib_convt::smtlib_convt(bool int_encoding, const namespacet &_ns,
     abort();
   }
 
-  solver_proc_pid = fork();
-  if (solver_proc_pid == 0) {
+  // Our ends of the pipes must not leak into solvers started later, or they
+  // would never see end-of-file on their input.
+  fcntl(outpipe[1], F_SETFD, FD_CLOEXEC);
+  fcntl(inpipe[0], F_SETFD, FD_CLOEXEC);
+
+  proc.pid = fork();
+  if (proc.pid == 0) {
     close(outpipe[1]);
     close(inpipe[0]);
     close(STDIN_FILENO);
@@ -97,73 +204,99 @@ smtlib_convt::smtlib_convt(bool int_encoding, const namespacet &_ns,
     close(inpipe[1]);
 
     // Voila
-    execlp(cmd.c_str(), cmd.c_str(), NULL);
-    std::cerr << "Exec of smtlib solver failed" << std::endl;
+    execlp(prog.c_str(), prog.c_str(), NULL);
+    std::cerr << "Exec of smtlib solver \"" << prog << "\" failed"
+              << std::endl;
     abort();
-  } else {
-    close(outpipe[0]);
-    close(inpipe[1]);
-    out_stream = fdopen(outpipe[1], "w");
-    in_stream = fdopen(inpipe[0], "r");
   }
 
-  // Execution continues as the parent ESBMC process. Child dying will
-  // trigger SIGPIPE or an EOF eventually, which we'll be able to detect
-  // and crash upon.
+  close(outpipe[0]);
+  close(inpipe[1]);
+  proc.in_stream = fdopen(inpipe[0], "r");
+  return outpipe[1];
+}
+
+int
+smtlib_convt::start_tee(const std::vector<int> &solver_fds)
+{
+  // A helper process copies everything we write to each solver, so that
+  // conversion only ever waits on one pipe. Solvers that go away (such as
+  // the losers of a check-sat race, once killed) are simply dropped.
+  int teepipe[2];
+  if (pipe(teepipe) != 0) {
+    std::cerr << "Couldn't open a pipe for smtlib solver" << std::endl;
+    abort();
+  }
 
-  // Point lexer input at output stream
-  smtlib_tokin = in_stream;
+  fcntl(teepipe[1], F_SETFD, FD_CLOEXEC);
+
+  tee_proc_pid = fork();
+  if (tee_proc_pid == 0) {
+    close(teepipe[1]);
+    for (const struct solver_proct &proc : solvers)
+      fclose(proc.in_stream);
+
+    signal(SIGPIPE, SIG_IGN);
+    std::vector<int> fds = solver_fds;
+    char buf[65536];
+    while (!fds.empty()) {
+      ssize_t len = read(teepipe[0], buf, sizeof(buf));
+      if (len < 0 && errno == EINTR)
+        continue;
+      if (len <= 0)
+        break;
+
+      for (std::vector<int>::iterator it = fds.begin(); it != fds.end(); ) {
+        ssize_t done = 0;
+        while (done < len) {
+          ssize_t w = write(*it, buf + done, len - done);
+          if (w < 0 && errno == EINTR)
+            continue;
+          if (w <= 0)
+            break;
+          done += w;
+        }
+
+        if (done < len) {
+          close(*it);
+          it = fds.erase(it);
+        } else {
+          it++;
+        }
+      }
+    }
 
-  fprintf(out_stream, "(set-logic %s)\n", logic.c_str());
-  fprintf(out_stream, "(set-info :status unknown)\n");
-  fprintf(out_stream, "(set-option :produce-models true)\n");
+    _exit(0);
+  }
 
-  // Fetch solver name and version.
-  fprintf(out_stream, "(get-info :name)\n");
-  fflush(out_stream);
-  smtlib_send_start_code = 1;
-  smtlibparse(TOK_START_INFO);
-
-  // As a result we should have a single entry in a list of sexprs.
-  class sexpr *sexpr = smtlib_output;
-  assert(sexpr->sexpr_list.size() == 1 &&
-         "More than one sexpr response to get-info name");
-  class sexpr &s = sexpr->sexpr_list.front();
-
-  // Should have a keyword followed by a string?
-  assert(s.token == 0 && s.sexpr_list.size() == 2 && "Bad solver name format");
-  class sexpr &keyword = s.sexpr_list.front();
-  class sexpr &value = s.sexpr_list.back();
-  assert(keyword.token == TOK_KEYWORD && keyword.data == ":name" &&
-         "Bad get-info :name response from solver");
-  assert(value.token == TOK_STRINGLIT && "Non-string solver name response");
-  solver_name = value.data;
-  delete smtlib_output;
+  close(teepipe[0]);
+  for (int fd : solver_fds)
+    close(fd);
 
-  // Duplicate / boilerplate;
-  fprintf(out_stream, "(get-info :version)\n");
-  fflush(out_stream);
-  smtlib_send_start_code = 1;
-  smtlibparse(TOK_START_INFO);
-
-  sexpr = smtlib_output;
-  assert(sexpr->sexpr_list.size() == 1 &&
-         "More than one sexpr response to get-info version");
-  class sexpr &v = sexpr->sexpr_list.front();
-
-  assert(v.token == 0 && v.sexpr_list.size() == 2 && "Bad solver version fmt");
-  class sexpr &kw = v.sexpr_list.front();
-  class sexpr &val = v.sexpr_list.back();
-  assert(kw.token == TOK_KEYWORD && kw.data == ":version" &&
-         "Bad get-info :version response from solver");
-  assert(val.token == TOK_STRINGLIT && "Non-string solver version response");
-  solver_version = val.data;
-  delete smtlib_output;
+  return teepipe[1];
 }
 
 smtlib_convt::~smtlib_convt()
 {
   delete_all_asts();
+
+  if (in_stream == nullptr) {
+    // Text output
+    fclose(out_stream);
+    return;
+  }
+
+  // Closing our output ends the session for the solvers (and the tee); any
+  // still busy with an abandoned query are killed outright.
+  fclose(out_stream);
+  for (const struct solver_proct &proc : solvers) {
+    fclose(proc.in_stream);
+    kill(proc.pid, SIGKILL);
+    waitpid(proc.pid, nullptr, 0);
+  }
+
+  if (tee_proc_pid != 0)
+    waitpid(tee_proc_pid, nullptr, 0);
 }
 
 std::string
@@ -322,6 +455,67 @@ smtlib_convt::dec_solve()
   if (in_stream == nullptr)
     return smt_convt::P_SMTLIB;
 
+  // With several solvers racing, take the first definite answer and stop
+  // the others; the winner alone answers any further queries.
+  while (solvers.size() > 1) {
+    std::vector<struct pollfd> fds(solvers.size());
+    for (unsigned int i = 0; i < solvers.size(); i++) {
+      fds[i].fd = fileno(solvers[i].in_stream);
+      fds[i].events = POLLIN;
+      fds[i].revents = 0;
+    }
+
+    if (poll(fds.data(), fds.size(), -1) < 0) {
+      if (errno == EINTR)
+        continue;
+      std::cerr << "Failed to wait for smtlib solvers" << std::endl;
+      abort();
+    }
+
+    unsigned int i = 0;
+    while (fds[i].revents == 0)
+      i++;
+
+    struct solver_proct proc = solvers[i];
+    solvers.erase(solvers.begin() + i);
+
+    // A solver that died shows up as end-of-file; anything other than sat
+    // or unsat just takes it out of the race.
+    unsigned int token = 0;
+    int c = fgetc(proc.in_stream);
+    if (c != EOF) {
+      ungetc(c, proc.in_stream);
+      smtlib_tokrestart(proc.in_stream);
+      smtlib_send_start_code = 1;
+      smtlibparse(TOK_START_SAT);
+      token = smtlib_output->token;
+      delete smtlib_output;
+    }
+
+    if (token == TOK_KW_SAT || token == TOK_KW_UNSAT) {
+      for (const struct solver_proct &loser : solvers) {
+        fclose(loser.in_stream);
+        kill(loser.pid, SIGKILL);
+        waitpid(loser.pid, nullptr, 0);
+      }
+
+      solvers.clear();
+      solvers.push_back(proc);
+      solver_proc_pid = proc.pid;
+      in_stream = proc.in_stream;
+      return (token == TOK_KW_SAT) ? smt_convt::P_SATISFIABLE
+                                   : smt_convt::P_UNSATISFIABLE;
+    }
+
+    fclose(proc.in_stream);
+    kill(proc.pid, SIGKILL);
+    waitpid(proc.pid, nullptr, 0);
+
+    in_stream = solvers.front().in_stream;
+    solver_proc_pid = solvers.front().pid;
+    smtlib_tokrestart(in_stream);
+  }
+
   // And read in the output
   smtlib_send_start_code = 1;
   smtlibparse(TOK_START_SAT);
@@ -646,6 +840,11 @@ smtlib_convt::assert_ast(const smt_ast *a)
 
   // Final brace for closing the 'assert'.
   fprintf(out_stream, ")\n");
+
+  // Hand each assertion over as soon as it's complete, so that the solver
+  // parses it while we carry on converting the rest of the formula.
+  if (in_stream != nullptr)
+    fflush(out_stream);
 }
 
 smt_ast *
@@ -8,6 +8,7 @@
 #include <string>
 #include <unistd.h>
 #include <util/irep2.h>
+#include <vector>
 
 class sexpr {
 public:
@@ -103,12 +104,28 @@ public:
 
   void push_ctx() override;
   void pop_ctx() override;
+  bool supports_ctx() const override { return true; }
+
+  struct solver_proct {
+    pid_t pid;
+    FILE *in_stream;
+  };
+
+  // Fork off prog; returns the fd of its input.
+  int start_solver(const std::string &prog, struct solver_proct &proc);
+  // Fork off a process copying one pipe to all solver inputs; returns the
+  // fd to write to.
+  int start_tee(const std::vector<int> &solver_fds);
 
   // Members
   const optionst &options;
+  // The solver we're talking to; the winner, once a race has been decided.
   pid_t solver_proc_pid;
   FILE *out_stream;
   FILE *in_stream;
+  // Every solver still running, the first of which is the one above
+  std::vector<struct solver_proct> solvers;
+  pid_t tee_proc_pid;
   std::string solver_name;
   std::string solver_version;
 
@@ -22,6 +22,9 @@ struct esbmc_solver_config {
 extern const struct esbmc_solver_config esbmc_solvers[];
 extern const unsigned int esbmc_num_solvers;
 
+extern const std::string list_of_all_solvers[];
+extern const unsigned int total_num_of_solvers;
+
 smt_convt *create_solver_factory(const std::string &solver_name,
                                   bool int_encoding, const namespacet &ns,
                                   const optionst &options);
@@ -97,6 +97,7 @@ public:
 
   void push_ctx() override;
   void pop_ctx() override;
+  bool supports_ctx() const override { return true; }
 
   smt_astt convert_array_of(smt_astt init_val, unsigned long domain_width) override;
 
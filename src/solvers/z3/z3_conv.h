@@ -70,6 +70,7 @@ private:
 public:
   void push_ctx() override;
   void pop_ctx() override;
+  bool supports_ctx() const override { return true; }
   smt_convt::resultt dec_solve() override;
   z3::check_result check2_z3_properties();
 
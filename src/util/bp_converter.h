@@ -94,3 +94,66 @@ struct esbmc_python_cvt
       return;
     }
 };
+
+// Python view of a persistent_mapt. The boost.python map suite wants mutable
+// iterators, which a persistent map doesn't have; instead, lookups return a
+// copy of the value, and assignments go through operator[].
+template <typename Map>
+void export_persistent_map(const char *name)
+{
+  using namespace boost::python;
+  typedef typename Map::key_type keyt;
+  typedef typename Map::mapped_type valuet;
+
+  struct wrapt
+  {
+    static size_t len(const Map &m)
+    {
+      return m.size();
+    }
+
+    static valuet get_item(const Map &m, const keyt &k)
+    {
+      typename Map::const_iterator it = m.find(k);
+      if (it == m.end()) {
+        PyErr_SetString(PyExc_KeyError, "Key not found");
+        throw_error_already_set();
+      }
+      return it->second;
+    }
+
+    static void set_item(Map &m, const keyt &k, const valuet &v)
+    {
+      m[k] = v;
+    }
+
+    static void del_item(Map &m, const keyt &k)
+    {
+      if (m.erase(k) == 0) {
+        PyErr_SetString(PyExc_KeyError, "Key not found");
+        throw_error_already_set();
+      }
+    }
+
+    static bool contains(const Map &m, const keyt &k)
+    {
+      return m.find(k) != m.end();
+    }
+
+    static list keys(const Map &m)
+    {
+      list l;
+      for (const auto &e : m)
+        l.append(e.first);
+      return l;
+    }
+  };
+
+  class_<Map>(name)
+    .def("__len__", &wrapt::len)
+    .def("__getitem__", &wrapt::get_item)
+    .def("__setitem__", &wrapt::set_item)
+    .def("__delitem__", &wrapt::del_item)
+    .def("__contains__", &wrapt::contains)
+    .def("keys", &wrapt::keys);
+}
@@ -9,10 +9,10 @@ public:
   boost::uuids::detail::sha1 s;
 };
 
-bool crypto_hash::operator<(const crypto_hash h2) const
+bool crypto_hash::operator<(const crypto_hash &h2) const
 {
 
-  if (memcmp(hash, h2.hash, CRYPTO_HASH_SIZE) < 0)
+  if (memcmp(hash, h2.hash, sizeof(hash)) < 0)
     return true;
 
   return false;
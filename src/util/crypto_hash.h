@@ -6,14 +6,14 @@
 
 class crypto_hash_private;
 
-#define CRYPTO_HASH_SIZE 32
+#define CRYPTO_HASH_SIZE 20
 
 class crypto_hash {
 public:
   std::shared_ptr<crypto_hash_private> p_crypto;
   unsigned int hash[5];
 
-  bool operator<(const crypto_hash h2) const;
+  bool operator<(const crypto_hash &h2) const;
 
   std::string to_string() const;
 
@@ -6,20 +6,48 @@ Author: Daniel Kroening, kroening@kroening.com
 
 \*******************************************************************/
 
+#include <set>
 #include <util/guard.h>
 #include <util/irep2_utils.h>
 #include <util/std_expr.h>
 
+guardt::nodet::nodet(const node_ptrt &_parent, const expr2tc &_conjunct)
+  : parent(_parent),
+    conjunct(_conjunct),
+    depth(guardt::depth(_parent.get()) + 1)
+{
+  // The chain of ands is extended, never rebuilt
+  if(parent == nullptr)
+    expr = conjunct;
+  else
+    expr = and2tc(parent->expr, conjunct);
+}
+
+guardt::nodet::~nodet()
+{
+  // Release the chain iteratively; a long one would otherwise be freed by
+  // a recursion as deep as the guard.
+  node_ptrt p;
+  p.swap(parent);
+  while(p != nullptr && p.use_count() == 1)
+  {
+    node_ptrt next;
+    next.swap(const_cast<nodet &>(*p).parent);
+    p.swap(next);
+  }
+}
+
 expr2tc guardt::as_expr() const
 {
   if(is_true())
     return gen_true_expr();
 
-  if(is_single_symbol())
-    return *guard_list.begin();
+  return tip->expr;
+}
 
-  assert(!is_nil_expr(g_expr));
-  return g_expr;
+void guardt::push(const expr2tc &expr)
+{
+  tip = std::make_shared<nodet>(tip, expr);
 }
 
 void guardt::add(const expr2tc &expr)
@@ -39,21 +67,7 @@ void guardt::add(const expr2tc &expr)
     return;
   }
 
-  guard_list.push_back(expr);
-
-  // Update the chain of ands
-
-  // Easy case, there is no g_expr
-  if(is_nil_expr(g_expr))
-  {
-    g_expr = expr;
-  }
-  else
-  {
-    // Otherwise, just update the chain of ands
-    and2tc new_g_expr(g_expr, expr);
-    g_expr.swap(new_g_expr);
-  }
+  push(expr);
 }
 
 void guardt::guard_expr(expr2tc& dest) const
@@ -72,54 +86,48 @@ void guardt::guard_expr(expr2tc& dest) const
   dest = expr2tc(new implies2t(as_expr(), dest));
 }
 
-void guardt::build_guard_expr()
+void guardt::append(const guardt &guard)
 {
-  // This method closely related to guardt::add and guardt::guard_expr
-  // We need to build the chain of ands, to avoid memory bloat on as_expr
-
-  // if the guard is true, or a single symbol, we don't need to build it
-  if(is_true() || is_single_symbol())
+  if(is_true())
+  {
+    tip = guard.tip;
     return;
+  }
 
-  // This method will only be used, when the guard is nil, for instance,
-  // guardt &operator -= and guardt &operator |=, all other cases should
-  // be handled by guardt::add
-  assert(is_nil_expr(g_expr));
-
-  // We can assume at least two operands
-  auto it = guard_list.begin();
-
-  expr2tc arg1, arg2;
-  arg1 = *it++;
-  arg2 = *it++;
-  and2tc res(arg1, arg2);
-  while (it != guard_list.end())
-    res = and2tc(res, *it++);
-
-  g_expr.swap(res);
-}
+  std::vector<expr2tc> conjuncts;
+  for(const nodet *n = guard.tip.get(); n != nullptr; n = n->parent.get())
+    conjuncts.push_back(n->conjunct);
 
-void guardt::append(const guardt &guard)
-{
-  for(auto const &it : guard.guard_list)
-    add(it);
+  for(auto it = conjuncts.rbegin(); it != conjuncts.rend(); it++)
+    add(*it);
 }
 
 guardt &operator -= (guardt &g1, const guardt &g2)
 {
-  guardt::guard_listt diff;
-  std::set_difference(
-    g1.guard_list.begin(),
-    g1.guard_list.end(),
-    g2.guard_list.begin(),
-    g2.guard_list.end(),
-    std::back_inserter(diff));
-
-  // Clear g1 and build the guard's list and expr
-  g1.clear();
+  // Usually g2 is what g1 branched from, and only its newer conjuncts are
+  // left. Anything that g2 added since they parted is dropped from those.
+  const guardt::nodet *a = g1.tip.get(), *b = g2.tip.get();
+  std::vector<expr2tc> suffix;
+  std::set<expr2tc> removed;
 
-  g1.guard_list.swap(diff);
-  g1.build_guard_expr();
+  while(a != b)
+  {
+    if(guardt::depth(a) >= guardt::depth(b))
+    {
+      suffix.push_back(a->conjunct);
+      a = a->parent.get();
+    }
+    else
+    {
+      removed.insert(b->conjunct);
+      b = b->parent.get();
+    }
+  }
+
+  g1.clear();
+  for(auto it = suffix.rbegin(); it != suffix.rend(); it++)
+    if(removed.find(*it) == removed.end())
+      g1.push(*it);
 
   return g1;
 }
@@ -130,109 +138,114 @@ guardt &operator |= (guardt &g1, const guardt &g2)
   if(g2.is_false() || g1.is_true()) return g1;
   if(g1.is_false() || g2.is_true()) { g1 = g2; return g1; }
 
-  if(g1.is_single_symbol() && g2.is_single_symbol())
+  // Everything that's common to both guards will not be or'd, e.g:
+  // g1 = !guard1 && !guard2 && !guard3
+  // g2 = !guard1 && guard2
+  // res = g1 || g2 = !guard1 && ((!guard2 && !guard3) || guard2)
+  // Guards from either side of a branch share the nodes before it, so only
+  // their suffixes need walking.
+  const guardt::nodet *a = g1.tip.get(), *b = g2.tip.get();
+  std::vector<const guardt::nodet *> suffix1, suffix2;
+  while(a != b)
   {
-    // Both guards have one symbol, so check if we opposite symbols, e.g,
-    // g1 == sym1 and g2 == !sym1
-    expr2tc or_expr(new or2t(*g1.guard_list.begin(), *g2.guard_list.begin()));
-    simplify(or_expr);
-
-    if(::is_true(or_expr)) { g1.make_true(); return g1; }
+    if(guardt::depth(a) >= guardt::depth(b))
+    {
+      suffix1.push_back(a);
+      a = a->parent.get();
+    }
+    if(guardt::depth(b) > guardt::depth(a))
+    {
+      suffix2.push_back(b);
+      b = b->parent.get();
+    }
+  }
 
-    // Despite if we could simplify or not, clear and set the new guard
-    g1.clear_insert(or_expr);
+  // Guards built separately can still start their suffixes alike
+  guardt::node_ptrt common =
+    suffix1.empty() ? g1.tip : suffix1.back()->parent;
+  while(!suffix1.empty() && !suffix2.empty() &&
+        suffix1.back()->conjunct == suffix2.back()->conjunct)
+  {
+    suffix1.pop_back();
+    suffix2.pop_back();
+    common = suffix1.empty() ? g1.tip : suffix1.back()->parent;
   }
-  else
+
+  // One implies the other
+  if(suffix1.empty() || suffix2.empty())
   {
-    // Here, we have a symbol (or symbols) in g2 to be or'd with the symbol
-    // (or symbols) in g1, e.g:
-    // g1 = !guard3 && !guard2 && !guard1
-    // g2 = guard2 && !guard1
-    // res = g1 || g2 = (!guard3 && !guard2 && !guard1) || (guard2 && !guard1)
-
-    // Simplify equation: everything that's common in both guards, will not
-    // be or'd
-
-    // Common guards
-    guardt common;
-    std::set_intersection(
-      g1.guard_list.begin(),
-      g1.guard_list.end(),
-      g2.guard_list.begin(),
-      g2.guard_list.end(),
-      std::back_inserter(common.guard_list));
-    common.build_guard_expr();
-
-    // New g1 and g2, without the common guards
-    guardt new_g1;
-    std::set_difference(
-      g1.guard_list.begin(),
-      g1.guard_list.end(),
-      common.guard_list.begin(),
-      common.guard_list.end(),
-      std::back_inserter(new_g1.guard_list));
-    new_g1.build_guard_expr();
-
-    guardt new_g2;
-    std::set_difference(
-      g2.guard_list.begin(),
-      g2.guard_list.end(),
-      common.guard_list.begin(),
-      common.guard_list.end(),
-      std::back_inserter(new_g2.guard_list));
-    new_g2.build_guard_expr();
-
-    // Get the and expression from both guards
-    expr2tc or_expr(new or2t(new_g1.as_expr(), new_g2.as_expr()));
-
-    // If the guards single symbols, try to simplify the or expression
-    if(new_g1.is_single_symbol() && new_g2.is_single_symbol())
-      simplify(or_expr);
-
-    g1.clear_append(common);
-    g1.add(or_expr);
+    g1.tip = common;
+    return g1;
   }
 
+  // Get the and expression of what's left of both guards
+  guardt new_g1, new_g2;
+  for(auto it = suffix1.rbegin(); it != suffix1.rend(); it++)
+    new_g1.push((*it)->conjunct);
+  for(auto it = suffix2.rbegin(); it != suffix2.rend(); it++)
+    new_g2.push((*it)->conjunct);
+
+  expr2tc or_expr(new or2t(new_g1.as_expr(), new_g2.as_expr()));
+
+  // If the guards single symbols, try to simplify the or expression
+  if(new_g1.is_single_symbol() && new_g2.is_single_symbol())
+    simplify(or_expr);
+
+  g1.tip = common;
+  g1.add(or_expr);
+
   return g1;
 }
 
 void
 guardt::dump() const
 {
-  for (auto const &it : guard_list)
-    it->dump();
+  std::vector<const nodet *> nodes;
+  for(const nodet *n = tip.get(); n != nullptr; n = n->parent.get())
+    nodes.push_back(n);
+
+  for(auto it = nodes.rbegin(); it != nodes.rend(); it++)
+    (*it)->conjunct->dump();
 }
 
 bool
 operator == (const guardt &g1, const guardt &g2)
 {
-  // Very simple: the guard list should be identical.
-  return g1.guard_list == g2.guard_list;
+  // Very simple: the conjuncts should be identical. Shared nodes needn't
+  // be compared.
+  const guardt::nodet *a = g1.tip.get(), *b = g2.tip.get();
+  if(guardt::depth(a) != guardt::depth(b))
+    return false;
+
+  for(; a != b; a = a->parent.get(), b = b->parent.get())
+    if(a->conjunct != b->conjunct)
+      return false;
+
+  return true;
 }
 
 void guardt::swap(guardt& g)
 {
-  guard_list.swap(g.guard_list);
-  g_expr.swap(g.g_expr);
+  tip.swap(g.tip);
 }
 
 bool guardt::is_true() const
 {
-  return guard_list.empty();
+  return tip == nullptr;
 }
 
 bool guardt::is_false() const
 {
   // Never false
-  if(guard_list.size() != 1)
+  if(!is_single_symbol())
     return false;
 
-  return (*guard_list.begin() == gen_false_expr());
+  return tip->conjunct == gen_false_expr();
 }
 
 void guardt::make_true()
 {
-  guard_list.clear();
+  clear();
 }
 
 void guardt::make_false()
@@ -242,13 +255,12 @@ void guardt::make_false()
 
 bool guardt::is_single_symbol() const
 {
-  return (guard_list.size() == 1);
+  return depth(tip.get()) == 1;
 }
 
 void guardt::clear()
 {
-  guard_list.clear();
-  g_expr.reset();
+  tip.reset();
 }
 
 void guardt::clear_append(const guardt& guard)
@@ -10,6 +10,7 @@ Author: Daniel Kroening, kroening@kroening.com
 #define CPROVER_GUARD_H
 
 #include <iostream>
+#include <memory>
 #include <util/expr.h>
 #include <util/irep2.h>
 #include <util/migrate.h>
@@ -19,11 +20,9 @@ class guardt
   friend void build_guard_python_class();
 
 public:
-  // Default constructors
+  // Default constructors. Copies share the whole chain of conjuncts, so they
+  // are cheap.
   guardt() = default;
-  guardt(const guardt &ref) { *this = ref; }
-
-  typedef std::vector<expr2tc> guard_listt;
 
   void add(const expr2tc &expr);
   void append(const guardt &guard);
@@ -45,15 +44,38 @@ public:
   void dump() const;
 
 protected:
-  guard_listt guard_list;
-  expr2tc g_expr;
+  // A guard is a chain of immutable nodes, one per conjunct, each pointing
+  // back at the one added before it. Guards that branched from a common one
+  // share its nodes, so finding what they have in common only needs to walk
+  // back over the conjuncts added since. Each node caches the conjunction
+  // up to itself, built once when the node is made.
+  struct nodet;
+  typedef std::shared_ptr<const nodet> node_ptrt;
+
+  struct nodet
+  {
+    node_ptrt parent;
+    expr2tc conjunct;
+    expr2tc expr;
+    unsigned int depth;
+
+    nodet(const node_ptrt &_parent, const expr2tc &_conjunct);
+    ~nodet();
+  };
+
+  node_ptrt tip;
+
+  static unsigned int depth(const nodet *n)
+  {
+    return n == nullptr ? 0 : n->depth;
+  }
 
   bool is_single_symbol() const;
   void clear();
   void clear_append(const guardt &guard);
   void clear_insert(const expr2tc &expr);
 
-  void build_guard_expr();
+  void push(const expr2tc &expr);
 };
 
 #endif
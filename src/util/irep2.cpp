@@ -1,8 +1,8 @@
 #include <ac_config.h>
 #include <boost/algorithm/string.hpp>
 #include <boost/functional/hash.hpp>
+#include <unordered_map>
 #include <util/fixedbv.h>
-#include <util/i2string.h>
 #include <util/ieee_float.h>
 #include <util/irep2_type.h>
 #include <util/irep2_expr.h>
@@ -201,6 +201,7 @@ get_type_id(const type2t &type)
 
 type2t::type2t(type_ids id)
   : type_id(id),
+    interned(false),
     crc_val(0)
 {
 }
@@ -534,13 +535,15 @@ type2t_traits<Args...>::make_contained(typename Args::result_type... args) -> ir
 /*************************** Base expr2t definitions **************************/
 
 expr2t::expr2t(const type2tc& _type, expr_ids id)
-  : std::enable_shared_from_this<expr2t>(), expr_id(id), type(_type), crc_val(0)
+  : std::enable_shared_from_this<expr2t>(), expr_id(id), interned(false),
+    type(_type), crc_val(0)
 {
 }
 
 expr2t::expr2t(const expr2t &ref)
   : std::enable_shared_from_this<expr2t>(),
     expr_id(ref.expr_id),
+    interned(false),
     type(ref.type),
     crc_val(ref.crc_val)
 {
@@ -653,6 +656,69 @@ expr2t::do_crc() const
   return this->crc_val;
 }
 
+/*************************** Hash consing ***************************/
+
+bool irep2_hash_consing = false;
+
+// Nodes are bucketed by crc; a bucket holds weak references, so interning
+// doesn't keep anything alive. Dead entries are dropped whenever a bucket is
+// walked, and the whole table is swept each time it doubles in size.
+template <class T>
+class irep2_intern_tablet
+{
+public:
+  irep2_intern_tablet() : sweep_at(1024) { }
+
+  void intern(irep_container<T> &ref)
+  {
+    size_t crc = ref.crc();
+    auto range = table.equal_range(crc);
+    for (auto it = range.first; it != range.second; ) {
+      std::shared_ptr<T> existing = it->second.lock();
+      if (!existing) {
+        it = table.erase(it);
+      } else if (*existing == *ref) {
+        ref = existing;
+        return;
+      } else {
+        it++;
+      }
+    }
+
+    if (table.size() >= sweep_at) {
+      for (auto it = table.begin(); it != table.end(); )
+        it = (it->second.expired()) ? table.erase(it) : std::next(it);
+      sweep_at = std::max(sweep_at, table.size() * 2);
+    }
+
+    // Through a const pointer: the mutable accessors would detach and reset
+    // the crc we just computed.
+    const T *node = static_cast<const irep_container<T> &>(ref).get();
+    node->interned = true;
+    table.emplace(crc, std::weak_ptr<T>(ref));
+  }
+
+protected:
+  std::unordered_multimap<size_t, std::weak_ptr<T> > table;
+  size_t sweep_at;
+};
+
+// Function-local statics, as global containers may be built during static
+// initialization.
+void
+irep2_intern(type2tc &ref)
+{
+  static irep2_intern_tablet<type2t> types;
+  types.intern(ref);
+}
+
+void
+irep2_intern(expr2tc &ref)
+{
+  static irep2_intern_tablet<expr2t> exprs;
+  exprs.intern(ref);
+}
+
 void
 expr2t::hash(crypto_hash &hash) const
 {
@@ -1060,31 +1126,105 @@ constant_bool2t::is_false() const
 
 std::string
 symbol_data::get_symbol_name() const
+{
+  return symbol_ssa_idt(*this).as_string();
+}
+
+symbol_ssa_idt::symbol_ssa_idt(const symbol_data &sym)
+  : base_name(sym.thename), rlevel(sym.rlevel), level1_num(0), thread_num(0),
+    node_num(0), level2_num(0)
 {
   switch (rlevel) {
-  case level0:
-    return thename.as_string();
-  case level1:
-    return thename.as_string() + "@" + i2string(level1_num)
-                               + "!" + i2string(thread_num);
-  case level2:
-    return thename.as_string() + "@" + i2string(level1_num)
-                               + "!" + i2string(thread_num)
-                               + "&" + i2string(node_num)
-                               + "#" + i2string(level2_num);
-  case level1_global:
-    // Just return global name,
-    return thename.as_string();
-  case level2_global:
-    // Global name with l2 details
-    return thename.as_string() + "&" + i2string(node_num)
-                               + "#" + i2string(level2_num);
+  case symbol_data::level2:
+    node_num = sym.node_num;
+    level2_num = sym.level2_num;
+    // Fallthrough
+  case symbol_data::level1:
+    level1_num = sym.level1_num;
+    thread_num = sym.thread_num;
+    break;
+  case symbol_data::level2_global:
+    node_num = sym.node_num;
+    level2_num = sym.level2_num;
+    break;
+  case symbol_data::level1_global:
+    // Named just like level0
+    rlevel = symbol_data::level0;
+    break;
+  case symbol_data::level0:
+    break;
   default:
     std::cerr << "Unrecognized renaming level enum" << std::endl;
     abort();
   }
 }
 
+bool
+symbol_ssa_idt::operator<(const symbol_ssa_idt &ref) const
+{
+  if (base_name.get_no() != ref.base_name.get_no())
+    return base_name.get_no() < ref.base_name.get_no();
+  if (rlevel != ref.rlevel)
+    return rlevel < ref.rlevel;
+  if (level1_num != ref.level1_num)
+    return level1_num < ref.level1_num;
+  if (thread_num != ref.thread_num)
+    return thread_num < ref.thread_num;
+  if (node_num != ref.node_num)
+    return node_num < ref.node_num;
+  return level2_num < ref.level2_num;
+}
+
+size_t
+symbol_ssa_idt::hash() const
+{
+  size_t seed = base_name.get_no();
+  boost::hash_combine(seed, (uint8_t)rlevel);
+  boost::hash_combine(seed, level1_num);
+  boost::hash_combine(seed, thread_num);
+  boost::hash_combine(seed, node_num);
+  boost::hash_combine(seed, level2_num);
+  return seed;
+}
+
+static inline void
+append_num(std::string &str, char sep, unsigned int num)
+{
+  char buf[16];
+  char *p = buf + sizeof(buf);
+  do {
+    *--p = '0' + (num % 10);
+    num /= 10;
+  } while (num != 0);
+
+  str += sep;
+  str.append(p, buf + sizeof(buf) - p);
+}
+
+std::string
+symbol_ssa_idt::as_string() const
+{
+  const std::string &base = base_name.as_string();
+  if (rlevel == symbol_data::level0)
+    return base;
+
+  std::string str;
+  str.reserve(base.size() + 44);
+  str = base;
+
+  if (rlevel != symbol_data::level2_global) {
+    append_num(str, '@', level1_num);
+    append_num(str, '!', thread_num);
+  }
+
+  if (rlevel != symbol_data::level1) {
+    append_num(str, '&', node_num);
+    append_num(str, '#', level2_num);
+  }
+
+  return str;
+}
+
 expr2tc
 constant_string2t::to_array() const
 {
@@ -2334,6 +2474,7 @@ esbmct::irep_methods2<derived, baseclass, traits, container, enable, fields>::cl
 {
   const derived *derived_this = static_cast<const derived*>(this);
   derived *new_obj = new derived(*derived_this);
+  new_obj->interned = false;
   return base_container2tc(new_obj);
 }
 
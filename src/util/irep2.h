@@ -220,7 +220,6 @@ public:
   irep_container & operator=(std::shared_ptr<Y> const & r)
   {
     std::shared_ptr<T>::operator=(r);
-    T *p = std::shared_ptr<T>::operator->();
     return *this;
   }
 
@@ -272,8 +271,10 @@ public:
 
   void detach()
   {
-    if (this->use_count() == 1)
-      return; // No point remunging oneself if we're the only user of the ptr.
+    // No point remunging oneself if we're the only user of the ptr. Interned
+    // nodes are always duplicated: the intern table may hand them out again.
+    if (this->use_count() == 1 && !std::shared_ptr<T>::get()->interned)
+      return;
 
     // Assign-operate ourself into containing a fresh copy of the data. This
     // creates a new reference counted object, and assigns it to ourself,
@@ -295,6 +296,18 @@ public:
 typedef irep_container<type2t> type2tc;
 typedef irep_container<expr2t> expr2tc;
 
+/** Hash-consing mode.
+ *  When set, every type2t and expr2t built through a something2tc constructor
+ *  is looked up in an intern table, and replaced by the existing node if an
+ *  equal one is still alive. Equal terms then share one node, so most
+ *  equality tests (and smt_cache lookups) are satisfied by comparing
+ *  pointers. The table only holds weak references.
+ */
+extern bool irep2_hash_consing;
+
+void irep2_intern(type2tc &ref);
+void irep2_intern(expr2tc &ref);
+
 typedef std::pair<std::string,std::string> member_entryt;
 typedef std::list<member_entryt> list_of_memberst;
 
@@ -491,6 +504,9 @@ public:
   // XXX XXX XXX this should be const
   type_ids type_id;
 
+  /** Set when this node is in the hash-consing intern table. */
+  mutable bool interned;
+
   mutable size_t crc_val;
 };
 
@@ -760,6 +776,9 @@ public:
   /** Instance of expr_ids recording tihs exprs type. */
   const expr_ids expr_id;
 
+  /** Set when this node is in the hash-consing intern table. */
+  mutable bool interned;
+
   /** Type of this expr. All exprs have a type. */
   type2tc type;
 
@@ -1292,7 +1311,11 @@ namespace esbmct {
 
     // Forward all constructors down to the contained type.
     template <typename ...Args>
-    something2tc(Args... args) : base2tc(new contained(args...)) { }
+    something2tc(Args... args) : base2tc(new contained(args...))
+    {
+      if (irep2_hash_consing)
+        irep2_intern(*this);
+    }
 
     typedef irep_container<base> base_container;
     typedef idtype id_field_type;
@@ -1325,8 +1348,11 @@ T2* get_pointer(esbmct::something2tc<T1, T2, T3, T4, T5, T6> const& p) {
 
 inline bool operator==(const type2tc &a, const type2tc &b)
 {
+  // Shared (or both nil) ireps; the common case when hash-consing
+  if (a.get() == b.get())
+    return true;
   // Handle nil ireps
-  if (is_nil_type(a) && is_nil_type(b))
+  else if (is_nil_type(a) && is_nil_type(b))
     return true;
   else if (is_nil_type(a) || is_nil_type(b))
     return false;
@@ -1359,7 +1385,9 @@ inline bool operator>(const type2tc &a, const type2tc &b)
 
 inline bool operator==(const expr2tc& a, const expr2tc& b)
 {
-  if (is_nil_expr(a) && is_nil_expr(b))
+  if (a.get() == b.get())
+    return true;
+  else if (is_nil_expr(a) && is_nil_expr(b))
     return true;
   else if (is_nil_expr(a) || is_nil_expr(b))
     return false;
@@ -167,6 +167,48 @@ public:
   typedef esbmct::expr2t_traits<thename_field, rlevel_field, level1_num_field, level2_num_field, thread_num_field, node_num_field> traits;
 };
 
+/** Identity of a renamed symbol: the interned base name plus the numbers
+ *  get_symbol_name() would spell out, with those that don't apply at the
+ *  symbol's renaming level zeroed. Two symbols have the same name exactly
+ *  when their identities are equal, so sets of SSA symbols can be keyed on
+ *  this rather than on freshly built strings. */
+class symbol_ssa_idt
+{
+public:
+  symbol_ssa_idt(const symbol_data &sym);
+
+  bool operator==(const symbol_ssa_idt &ref) const
+  {
+    return base_name == ref.base_name && rlevel == ref.rlevel &&
+           level1_num == ref.level1_num && thread_num == ref.thread_num &&
+           node_num == ref.node_num && level2_num == ref.level2_num;
+  }
+
+  bool operator<(const symbol_ssa_idt &ref) const;
+
+  size_t hash() const;
+
+  /** The name as get_symbol_name() returns it */
+  std::string as_string() const;
+
+  irep_idt base_name;
+  symbol_data::renaming_level rlevel;
+  unsigned int level1_num;
+  unsigned int thread_num;
+  unsigned int node_num;
+  unsigned int level2_num;
+};
+
+struct symbol_ssa_id_hash
+{
+  size_t operator()(const symbol_ssa_idt &id) const { return id.hash(); }
+
+  bool operator()(const symbol_ssa_idt &a, const symbol_ssa_idt &b) const
+  {
+    return a < b;
+  }
+};
+
 class typecast_data : public expr2t
 {
 public:
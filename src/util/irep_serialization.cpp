@@ -171,8 +171,11 @@ void irep_serializationt::write_string_ref(
   if (id>=ireps_container.string_map.size()) 
     ireps_container.string_map.resize(id+1, false);
      
-  if (ireps_container.string_map[id])
+  if (ireps_container.string_map[id] || ireps_container.string_table)
+  {
+    ireps_container.string_map[id]=true;
     write_long(out, id);
+  }
   else
   {
     ireps_container.string_map[id]=true;
@@ -192,6 +195,11 @@ irep_idt irep_serializationt::read_string_ref( std::istream& in )
   {
     return ireps_container.string_rev_map[id].second;
   }
+  else if(ireps_container.string_table)
+  {
+    std::cerr << "string " << id << " missing from string table" << std::endl;
+    throw 0;
+  }
   else
   {
     dstring s=read_string(in);
@@ -72,7 +72,14 @@ public:
 
     typedef std::vector<std::pair<bool, dstring> > string_rev_mapt;
     string_rev_mapt string_rev_map;
-    
+
+    // When set, strings are only ever written by number. The writer emits
+    // the strings it used as a separate table, which the reader loads into
+    // string_rev_map before reading anything else.
+    bool string_table;
+
+    ireps_containert() : string_table(false) { }
+
     void clear()
     { 
       ireps_on_write.clear(); 
@@ -80,6 +87,14 @@ public:
       string_map.clear();
       string_rev_map.clear();
     }        
+
+    // Restart irep numbering, keeping the strings seen so far; allows parts
+    // of a stream to be decoded independently of each other.
+    void clear_ireps()
+    {
+      ireps_on_write.clear();
+      ireps_on_read.clear();
+    }
   };
   
   irep_serializationt(ireps_containert& ic): 
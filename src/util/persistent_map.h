@@ -0,0 +1,576 @@
+/*******************************************************************\
+
+Module: Persistent hash map with structural sharing
+
+\*******************************************************************/
+
+#ifndef CPROVER_PERSISTENT_MAP_H
+#define CPROVER_PERSISTENT_MAP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+/** Hash array mapped trie, in the compressed form of Steindorfer and Vinju
+ *  ("Optimizing Hash-Array Mapped Tries for Fast and Lean Immutable JVM
+ *  Collections"). Each node consumes five bits of the hash, and holds the
+ *  entries that end there separately from its subnodes; hashes that collide
+ *  in every bit end up in a plain list at the bottom.
+ *
+ *  Copying a map only copies the root pointer. Nodes, and the key/value pairs
+ *  they point at, are shared between copies until one of them is written to,
+ *  at which point the path from the root to the entry is duplicated, along
+ *  with the entry itself. Nodes and entries that are not shared are updated
+ *  in place, so a map that was never copied behaves much like an ordinary
+ *  hash map.
+ *
+ *  Only const iteration is offered; values are changed through operator[] or
+ *  get_mutable, which do the copying described above. diff walks two maps
+ *  that descend from a common copy and skips every subtree they still share.
+ */
+template <class Key, class T, class Hash = std::hash<Key>,
+          class Equal = std::equal_to<Key> >
+class persistent_mapt
+{
+public:
+  typedef Key key_type;
+  typedef T mapped_type;
+  typedef std::pair<Key, T> value_type;
+
+protected:
+  static const unsigned int bits = 5;
+  static const unsigned int fanout = 1u << bits;
+  // From here on there are no hash bits left, and nodes are collision lists
+  static const unsigned int max_shift = sizeof(size_t) * 8;
+
+  struct entryt
+  {
+    size_t hash;
+    std::shared_ptr<value_type> leaf;
+  };
+
+  struct nodet;
+  typedef std::shared_ptr<nodet> node_ptrt;
+
+  struct nodet
+  {
+    nodet() : datamap(0), nodemap(0) { }
+
+    uint32_t datamap;
+    uint32_t nodemap;
+    // In bit order, or in no particular order for a collision list
+    std::vector<entryt> entries;
+    std::vector<node_ptrt> children;
+  };
+
+  static unsigned int fragment(size_t hash, unsigned int shift)
+  {
+    return (hash >> shift) & (fanout - 1);
+  }
+
+  static unsigned int position(uint32_t map, uint32_t bit)
+  {
+    return __builtin_popcount(map & (bit - 1));
+  }
+
+public:
+  class const_iterator
+  {
+  public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef typename persistent_mapt::value_type value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef const value_type *pointer;
+    typedef const value_type &reference;
+
+    const_iterator() = default;
+
+    reference operator*() const
+    {
+      const framet &f = stack.back();
+      return *f.node->entries[f.pos].leaf;
+    }
+
+    pointer operator->() const
+    {
+      return &**this;
+    }
+
+    const_iterator &operator++()
+    {
+      stack.back().pos++;
+      settle();
+      return *this;
+    }
+
+    const_iterator operator++(int)
+    {
+      const_iterator tmp = *this;
+      ++*this;
+      return tmp;
+    }
+
+    bool operator==(const const_iterator &ref) const
+    {
+      if(stack.empty() || ref.stack.empty())
+        return stack.empty() == ref.stack.empty();
+
+      return stack.back().node == ref.stack.back().node
+             && stack.back().pos == ref.stack.back().pos;
+    }
+
+    bool operator!=(const const_iterator &ref) const
+    {
+      return !(*this == ref);
+    }
+
+  protected:
+    friend class persistent_mapt;
+
+    // Position within a node: below entries.size() it's an entry, above it
+    // it's one past the child being visited.
+    struct framet
+    {
+      const nodet *node;
+      size_t pos;
+    };
+    std::vector<framet> stack;
+
+    // Move forward to the next entry, if not already at one
+    void settle()
+    {
+      while(!stack.empty())
+      {
+        framet &f = stack.back();
+        if(f.pos < f.node->entries.size())
+          return;
+
+        size_t child = f.pos - f.node->entries.size();
+        if(child < f.node->children.size())
+        {
+          f.pos++;
+          stack.push_back({ f.node->children[child].get(), 0 });
+          continue;
+        }
+
+        stack.pop_back();
+      }
+    }
+  };
+
+  typedef const_iterator iterator;
+
+  persistent_mapt() : count(0) { }
+
+  size_t size() const { return count; }
+  bool empty() const { return count == 0; }
+
+  void clear()
+  {
+    root.reset();
+    count = 0;
+  }
+
+  void swap(persistent_mapt &ref)
+  {
+    root.swap(ref.root);
+    std::swap(count, ref.count);
+  }
+
+  const_iterator begin() const
+  {
+    const_iterator it;
+    if(root)
+    {
+      it.stack.push_back({ root.get(), 0 });
+      it.settle();
+    }
+    return it;
+  }
+
+  const_iterator end() const
+  {
+    return const_iterator();
+  }
+
+  const_iterator find(const Key &key) const
+  {
+    size_t hash = Hash()(key);
+    const_iterator it;
+    const nodet *n = root.get();
+    unsigned int shift = 0;
+
+    while(n != nullptr)
+    {
+      if(shift >= max_shift)
+      {
+        for(size_t i = 0; i < n->entries.size(); i++)
+          if(matches(n->entries[i], hash, key))
+          {
+            it.stack.push_back({ n, i });
+            return it;
+          }
+        return end();
+      }
+
+      uint32_t bit = 1u << fragment(hash, shift);
+      if(n->datamap & bit)
+      {
+        size_t i = position(n->datamap, bit);
+        if(!matches(n->entries[i], hash, key))
+          return end();
+        it.stack.push_back({ n, i });
+        return it;
+      }
+
+      if(!(n->nodemap & bit))
+        return end();
+
+      size_t child = position(n->nodemap, bit);
+      it.stack.push_back({ n, n->entries.size() + child + 1 });
+      n = n->children[child].get();
+      shift += bits;
+    }
+
+    return end();
+  }
+
+  size_t count_key(const Key &key) const
+  {
+    return find(key) == end() ? 0 : 1;
+  }
+
+  /** Value for key, inserting a default constructed one if there's none.
+   *  Unshares the path to it. */
+  T &operator[](const Key &key)
+  {
+    bool inserted;
+    return get_or_insert(key, inserted).second;
+  }
+
+  /** Value for key that may be written to, or nullptr if there's none */
+  T *get_mutable(const Key &key)
+  {
+    if(find(key) == end())
+      return nullptr;
+
+    bool inserted;
+    return &get_or_insert(key, inserted).second;
+  }
+
+  std::pair<const_iterator, bool> insert(const value_type &value)
+  {
+    const_iterator it = find(value.first);
+    if(it != end())
+      return std::make_pair(it, false);
+
+    bool inserted;
+    get_or_insert(value.first, inserted).second = value.second;
+    return std::make_pair(find(value.first), true);
+  }
+
+  size_t erase(const Key &key)
+  {
+    // Don't unshare anything on the way to a key that isn't there
+    if(find(key) == end())
+      return 0;
+
+    erase_rec(root, 0, Hash()(key), key);
+    if(--count == 0)
+      root.reset();
+    return 1;
+  }
+
+  /** Calls f(key, mine, theirs) for every key whose value differs between the
+   *  two maps, with nullptr standing for a key that is absent from one side.
+   *  Values that are still shared are skipped without being compared, as are
+   *  whole subtrees. */
+  template <class F>
+  void diff(const persistent_mapt &theirs, F f) const
+  {
+    diff_rec(root.get(), theirs.root.get(), 0, f);
+  }
+
+protected:
+  node_ptrt root;
+  size_t count;
+
+  static bool matches(const entryt &e, size_t hash, const Key &key)
+  {
+    return e.hash == hash && Equal()(e.leaf->first, key);
+  }
+
+  static nodet *unshare(node_ptrt &n)
+  {
+    if(!n)
+      n = std::make_shared<nodet>();
+    else if(n.use_count() > 1)
+      n = std::make_shared<nodet>(*n);
+    return n.get();
+  }
+
+  static value_type &unshare(entryt &e)
+  {
+    if(e.leaf.use_count() > 1)
+      e.leaf = std::make_shared<value_type>(*e.leaf);
+    return *e.leaf;
+  }
+
+  // Store e in the (new) node n, which sits at the given shift
+  static void place(nodet &n, unsigned int shift, const entryt &e)
+  {
+    if(shift >= max_shift)
+    {
+      n.entries.push_back(e);
+      return;
+    }
+
+    uint32_t bit = 1u << fragment(e.hash, shift);
+    n.entries.insert(n.entries.begin() + position(n.datamap, bit), e);
+    n.datamap |= bit;
+  }
+
+  value_type &get_or_insert(const Key &key, bool &inserted)
+  {
+    size_t hash = Hash()(key);
+    node_ptrt *p = &root;
+    unsigned int shift = 0;
+
+    while(true)
+    {
+      nodet *n = unshare(*p);
+
+      if(shift >= max_shift)
+      {
+        for(auto &e : n->entries)
+          if(matches(e, hash, key))
+          {
+            inserted = false;
+            return unshare(e);
+          }
+
+        n->entries.push_back({ hash, std::make_shared<value_type>(key, T()) });
+        count++;
+        inserted = true;
+        return *n->entries.back().leaf;
+      }
+
+      uint32_t bit = 1u << fragment(hash, shift);
+
+      if(n->nodemap & bit)
+      {
+        p = &n->children[position(n->nodemap, bit)];
+        shift += bits;
+        continue;
+      }
+
+      if(n->datamap & bit)
+      {
+        size_t i = position(n->datamap, bit);
+        if(matches(n->entries[i], hash, key))
+        {
+          inserted = false;
+          return unshare(n->entries[i]);
+        }
+
+        // Another key ends here: push it down a level and carry on there
+        node_ptrt child = std::make_shared<nodet>();
+        place(*child, shift + bits, n->entries[i]);
+        n->entries.erase(n->entries.begin() + i);
+        n->datamap &= ~bit;
+
+        size_t c = position(n->nodemap, bit);
+        n->children.insert(n->children.begin() + c, child);
+        n->nodemap |= bit;
+        p = &n->children[c];
+        shift += bits;
+        continue;
+      }
+
+      size_t i = position(n->datamap, bit);
+      n->entries.insert(
+        n->entries.begin() + i,
+        { hash, std::make_shared<value_type>(key, T()) });
+      n->datamap |= bit;
+      count++;
+      inserted = true;
+      return *n->entries[i].leaf;
+    }
+  }
+
+  static void erase_rec(
+    node_ptrt &p,
+    unsigned int shift,
+    size_t hash,
+    const Key &key)
+  {
+    nodet *n = unshare(p);
+
+    if(shift >= max_shift)
+    {
+      for(size_t i = 0; i < n->entries.size(); i++)
+        if(matches(n->entries[i], hash, key))
+        {
+          n->entries.erase(n->entries.begin() + i);
+          return;
+        }
+      return;
+    }
+
+    uint32_t bit = 1u << fragment(hash, shift);
+    if(n->datamap & bit)
+    {
+      n->entries.erase(n->entries.begin() + position(n->datamap, bit));
+      n->datamap &= ~bit;
+      return;
+    }
+
+    size_t c = position(n->nodemap, bit);
+    erase_rec(n->children[c], shift + bits, hash, key);
+
+    // Keep the trie canonical: a child left with at most one entry and no
+    // subnodes is folded back into this node.
+    const nodet *child = n->children[c].get();
+    if(child->children.empty() && child->entries.size() <= 1)
+    {
+      if(child->entries.size() == 1)
+      {
+        entryt e = child->entries[0];
+        n->entries.insert(
+          n->entries.begin() + position(n->datamap, bit), e);
+        n->datamap |= bit;
+      }
+
+      n->children.erase(n->children.begin() + c);
+      n->nodemap &= ~bit;
+    }
+  }
+
+  template <class F>
+  static void for_each(const nodet *n, F f)
+  {
+    for(auto const &e : n->entries)
+      f(e);
+    for(auto const &c : n->children)
+      for_each(c.get(), f);
+  }
+
+  template <class F>
+  static void report(const entryt *mine, const entryt *theirs, F &f)
+  {
+    if(mine != nullptr && theirs != nullptr)
+    {
+      if(mine->leaf != theirs->leaf)
+        f(mine->leaf->first, &mine->leaf->second, &theirs->leaf->second);
+    }
+    else if(mine != nullptr)
+      f(mine->leaf->first, &mine->leaf->second, (const T *)nullptr);
+    else
+      f(theirs->leaf->first, (const T *)nullptr, &theirs->leaf->second);
+  }
+
+  // One side has a single entry (or nothing) where the other has a subtree
+  template <class F>
+  static void diff_entry_subtree(
+    const entryt *e,
+    const nodet *sub,
+    bool entry_is_mine,
+    F &f)
+  {
+    bool matched = false;
+    for_each(sub, [&](const entryt &s) {
+      const entryt *other = nullptr;
+      if(e != nullptr && !matched && matches(s, e->hash, e->leaf->first))
+      {
+        matched = true;
+        other = e;
+      }
+
+      if(entry_is_mine)
+        report(other, &s, f);
+      else
+        report(&s, other, f);
+    });
+
+    if(e != nullptr && !matched)
+    {
+      if(entry_is_mine)
+        report(e, nullptr, f);
+      else
+        report(nullptr, e, f);
+    }
+  }
+
+  template <class F>
+  static void diff_rec(
+    const nodet *mine,
+    const nodet *theirs,
+    unsigned int shift,
+    F &f)
+  {
+    if(mine == theirs)
+      return;
+
+    if(mine == nullptr || theirs == nullptr)
+    {
+      diff_entry_subtree(nullptr, mine ? mine : theirs, theirs != nullptr, f);
+      return;
+    }
+
+    if(shift >= max_shift)
+    {
+      for(auto const &m : mine->entries)
+      {
+        const entryt *other = nullptr;
+        for(auto const &t : theirs->entries)
+          if(matches(t, m.hash, m.leaf->first))
+            other = &t;
+        report(&m, other, f);
+      }
+
+      for(auto const &t : theirs->entries)
+      {
+        bool found = false;
+        for(auto const &m : mine->entries)
+          found |= matches(m, t.hash, t.leaf->first);
+        if(!found)
+          report(nullptr, &t, f);
+      }
+      return;
+    }
+
+    for(unsigned int i = 0; i < fanout; i++)
+    {
+      uint32_t bit = 1u << i;
+
+      const entryt *me = (mine->datamap & bit)
+        ? &mine->entries[position(mine->datamap, bit)] : nullptr;
+      const entryt *te = (theirs->datamap & bit)
+        ? &theirs->entries[position(theirs->datamap, bit)] : nullptr;
+      const nodet *mc = (mine->nodemap & bit)
+        ? mine->children[position(mine->nodemap, bit)].get() : nullptr;
+      const nodet *tc = (theirs->nodemap & bit)
+        ? theirs->children[position(theirs->nodemap, bit)].get() : nullptr;
+
+      if(mc != nullptr && tc != nullptr)
+        diff_rec(mc, tc, shift + bits, f);
+      else if(mc != nullptr)
+        diff_entry_subtree(te, mc, false, f);
+      else if(tc != nullptr)
+        diff_entry_subtree(me, tc, true, f);
+      else if(me != nullptr && te != nullptr
+              && !matches(*te, me->hash, me->leaf->first))
+      {
+        report(me, nullptr, f);
+        report(nullptr, te, f);
+      }
+      else if(me != nullptr || te != nullptr)
+        report(me, te, f);
+    }
+  }
+};
+
+#endif
@@ -0,0 +1,139 @@
+/*******************************************************************\
+
+Module: Node pool allocator for node-based containers
+
+\*******************************************************************/
+
+#ifndef CPROVER_POOL_ALLOCATOR_H
+#define CPROVER_POOL_ALLOCATOR_H
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+/** Pool of fixed size nodes.
+ *  Nodes are carved out of large chunks and recycled through a free list;
+ *  the chunks themselves are only handed back when the pool is destroyed.
+ *  The node size is fixed by the first allocation, which suits node based
+ *  containers such as std::list: those only ever allocate one kind of node.
+ */
+class node_poolt
+{
+public:
+  explicit node_poolt(std::size_t _nodes_per_chunk = 1024)
+    : node_size(0), nodes_per_chunk(_nodes_per_chunk), free_list(nullptr),
+      cur(nullptr), end(nullptr)
+  {
+  }
+
+  node_poolt(const node_poolt &ref) = delete;
+  node_poolt &operator=(const node_poolt &ref) = delete;
+
+  ~node_poolt()
+  {
+    for (char *chunk : chunks)
+      ::operator delete(chunk);
+  }
+
+  /** Whether this pool can hand out nodes of the given size. */
+  bool serves(std::size_t size)
+  {
+    size = std::max(size, sizeof(free_nodet));
+    if (node_size == 0)
+      node_size = size;
+    return size == node_size;
+  }
+
+  void *allocate()
+  {
+    if (free_list != nullptr) {
+      free_nodet *node = free_list;
+      free_list = node->next;
+      return node;
+    }
+
+    if (cur == end) {
+      chunks.push_back(
+        static_cast<char *>(::operator new(node_size * nodes_per_chunk)));
+      cur = chunks.back();
+      end = cur + node_size * nodes_per_chunk;
+    }
+
+    void *node = cur;
+    cur += node_size;
+    return node;
+  }
+
+  void deallocate(void *p)
+  {
+    free_nodet *node = static_cast<free_nodet *>(p);
+    node->next = free_list;
+    free_list = node;
+  }
+
+protected:
+  struct free_nodet
+  {
+    free_nodet *next;
+  };
+
+  std::size_t node_size;
+  std::size_t nodes_per_chunk;
+  std::vector<char *> chunks;
+  free_nodet *free_list;
+  char *cur, *end;
+};
+
+/** Stateful allocator drawing single objects from a shared node_poolt.
+ *  Copies of a container share the pool of the original, so all the copies
+ *  made of one container release their memory in one go once the last of
+ *  them is destroyed. Array allocations go to the global heap.
+ */
+template <class T>
+class pool_allocatort
+{
+public:
+  typedef T value_type;
+  typedef std::true_type propagate_on_container_copy_assignment;
+  typedef std::true_type propagate_on_container_move_assignment;
+  typedef std::true_type propagate_on_container_swap;
+
+  pool_allocatort() : pool(std::make_shared<node_poolt>()) { }
+
+  template <class U>
+  pool_allocatort(const pool_allocatort<U> &ref) : pool(ref.pool) { }
+
+  T *allocate(std::size_t n)
+  {
+    if (n == 1 && pool->serves(sizeof(T)))
+      return static_cast<T *>(pool->allocate());
+    return static_cast<T *>(::operator new(n * sizeof(T)));
+  }
+
+  void deallocate(T *p, std::size_t n)
+  {
+    if (n == 1 && pool->serves(sizeof(T)))
+      pool->deallocate(p);
+    else
+      ::operator delete(p);
+  }
+
+  std::shared_ptr<node_poolt> pool;
+};
+
+template <class T, class U>
+inline bool operator==(const pool_allocatort<T> &a, const pool_allocatort<U> &b)
+{
+  return a.pool == b.pool;
+}
+
+template <class T, class U>
+inline bool operator!=(const pool_allocatort<T> &a, const pool_allocatort<U> &b)
+{
+  return a.pool != b.pool;
+}
+
+#endif
@@ -9,11 +9,13 @@ Author: Daniel Kroening, kroening@kroening.com
 #include <cassert>
 #include <cstring>
 #include <iostream>
+#include <new>
 #include <util/string_container.h>
 
 string_containert string_container __attribute__((init_priority(101)));
 
-string_ptrt::string_ptrt(const char *_s):s(_s), len(strlen(_s))
+string_ptrt::string_ptrt(const char *_s):s(_s), len(strlen(_s)),
+  hash(hash_string(_s))
 {
 }
 
@@ -24,48 +26,66 @@ bool operator==(const string_ptrt a, const string_ptrt b)
   return memcmp(a.s, b.s, a.len)==0;
 }
 
-unsigned string_containert::get(const char *s)
+string_containert::string_containert() : next_no(0)
 {
-  string_ptrt string_ptr(s);
+  for(auto &chunk : chunks)
+    chunk.store(nullptr, std::memory_order_relaxed);
 
-  hash_tablet::iterator it=hash_table.find(string_ptr);
-  
-  if(it!=hash_table.end())
-    return it->second;
-
-  unsigned r=hash_table.size();
-
-  // these are stable
-  string_list.emplace_back(s);
-  string_ptrt result(string_list.back());
+  // allocate empty string -- this gets index 0
+  get(string_ptrt(""));
+}
 
-  hash_table[result]=r;
-  
-  // these are not
-  string_vector.push_back(&string_list.back());
+string_containert::~string_containert()
+{
+  unsigned num = next_no.load();
+  for(unsigned c = 0; c < max_chunks; c++)
+  {
+    std::string *chunk = chunks[c].load();
+    if(chunk == nullptr)
+      continue;
+
+    for(unsigned i = 0; i < chunk_size && c * chunk_size + i < num; i++)
+      chunk[i].~basic_string();
+
+    ::operator delete(chunk);
+  }
+}
 
-  return r;
+std::string *string_containert::get_slot(unsigned no)
+{
+  std::atomic<std::string *> &chunk = chunks[no >> chunk_bits];
+  std::string *p = chunk.load(std::memory_order_acquire);
+
+  if(p == nullptr)
+  {
+    // Whoever first needs a chunk allocates it; racing threads back off
+    // and use the winner's.
+    std::string *fresh =
+      static_cast<std::string *>(::operator new(chunk_size * sizeof(std::string)));
+    if(chunk.compare_exchange_strong(p, fresh, std::memory_order_acq_rel))
+      p = fresh;
+    else
+      ::operator delete(fresh);
+  }
+
+  return &p[no & (chunk_size - 1)];
 }
 
-unsigned string_containert::get(const std::string &s)
+unsigned string_containert::get(const string_ptrt &s)
 {
-  string_ptrt string_ptr(s);
+  shardt &shard = shards[(s.hash ^ (s.hash >> 16)) % num_shards];
+  std::lock_guard<std::mutex> guard(shard.lock);
 
-  hash_tablet::iterator it=hash_table.find(string_ptr);
-  
-  if(it!=hash_table.end())
+  hash_tablet::const_iterator it = shard.hash_table.find(s);
+  if(it != shard.hash_table.end())
     return it->second;
 
-  unsigned r=hash_table.size();
+  unsigned r = next_no.fetch_add(1, std::memory_order_relaxed);
+  assert(r < unsigned(max_chunks) * chunk_size);
 
   // these are stable
-  string_list.push_back(s);
-  string_ptrt result(string_list.back());
-
-  hash_table[result]=r;
-  
-  // these are not
-  string_vector.push_back(&string_list.back());
+  std::string *str = new (get_slot(r)) std::string(s.s, s.len);
+  shard.hash_table.emplace(string_ptrt(*str, s.hash), r);
 
   return r;
 }
@@ -9,25 +9,33 @@ Author: Daniel Kroening, kroening@kroening.com
 #ifndef STRING_CONTAINER_H
 #define STRING_CONTAINER_H
 
+#include <atomic>
 #include <cassert>
-#include <list>
+#include <mutex>
+#include <string>
 #include <util/hash_cont.h>
 #include <util/string_hash.h>
-#include <vector>
 
 struct string_ptrt
 {
   const char *s;
   unsigned len;
-  
+  size_t hash;
+
   const char *c_str() const
   {
     return s;
   }
-  
+
   explicit string_ptrt(const char *_s);
 
-  explicit string_ptrt(const std::string &_s):s(_s.c_str()), len(_s.size())
+  explicit string_ptrt(const std::string &_s)
+    : s(_s.c_str()), len(_s.size()), hash(hash_string(_s))
+  {
+  }
+
+  string_ptrt(const std::string &_s, size_t _hash)
+    : s(_s.c_str()), len(_s.size()), hash(_hash)
   {
   }
 
@@ -39,55 +47,72 @@ bool operator==(const string_ptrt a, const string_ptrt b);
 class string_ptr_hash hash_map_hasher_superclass(std::string)
 {
 public:
-  size_t operator()(const string_ptrt s) const { return hash_string(s.s); }
+  size_t operator()(const string_ptrt s) const { return s.hash; }
   bool operator()(const string_ptrt &s1, const string_ptrt &s2) const {
-    return hash_string(s1.s) < hash_string(s2.s);
+    return s1.hash < s2.hash;
   }
 };
 
+/** Interns strings, numbering them in order of first appearance.
+ *  Safe to use from several threads at once: the hash table is split into
+ *  shards, each with its own lock, and numbers are handed out by an atomic
+ *  counter. The strings themselves live in fixed size chunks which never
+ *  move, so get_string() and c_str() take no lock at all.
+ */
 class string_containert
 {
 public:
   unsigned operator[](const char *s)
   {
-    return get(s);
+    return get(string_ptrt(s));
   }
-  
+
   unsigned operator[](const std::string &s)
   {
-    return get(s);
-  }
-  
-  string_containert()
-  {
-    // allocate empty string -- this gets index 0
-    get("");
+    return get(string_ptrt(s));
   }
-  
+
+  string_containert();
+  ~string_containert();
+
+  string_containert(const string_containert &ref) = delete;
+  string_containert &operator=(const string_containert &ref) = delete;
+
   const char *c_str(unsigned no) const
   {
-    assert(no < string_vector.size());
-    return string_vector[no]->c_str();
+    return get_string(no).c_str();
   }
-  
+
   const std::string &get_string(unsigned no) const
   {
-    assert(no < string_vector.size());
-    return *string_vector[no];
+    assert(no < next_no.load(std::memory_order_relaxed));
+    return chunks[no >> chunk_bits].load(std::memory_order_acquire)
+      [no & (chunk_size - 1)];
   }
 
 protected:
+  enum {
+    chunk_bits = 14,
+    chunk_size = 1 << chunk_bits,
+    max_chunks = 1 << 14,
+    num_shards = 64
+  };
+
   typedef hash_map_cont<string_ptrt, unsigned, string_ptr_hash> hash_tablet;
-  hash_tablet hash_table;
-  
-  unsigned get(const char *s);
-  unsigned get(const std::string &s);
-  
-  typedef std::list<std::string> string_listt;
-  string_listt string_list;
-  
-  typedef std::vector<std::string *> string_vectort;
-  string_vectort string_vector;
+
+  struct shardt
+  {
+    std::mutex lock;
+    hash_tablet hash_table;
+  };
+
+  shardt shards[num_shards];
+
+  std::atomic<unsigned> next_no;
+  std::atomic<std::string *> chunks[max_chunks];
+
+  unsigned get(const string_ptrt &s);
+  std::string *get_slot(unsigned no);
 };
 
 extern string_containert string_container;
@@ -0,0 +1,175 @@
+/*******************************************************************\
+
+Module: Benchmark for the string container
+
+Not built by default; run "make string_container_bench" in this
+directory. Compares the sharded container against the single table
+design it replaced, single threaded, and then interns from several
+threads at once.
+
+\*******************************************************************/
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <list>
+#include <string>
+#include <thread>
+#include <util/string_container.h>
+#include <vector>
+
+// The previous design: one hash table, strings kept in a list, and a vector
+// mapping numbers back to them.
+class single_string_containert
+{
+public:
+  single_string_containert()
+  {
+    get("");
+  }
+
+  unsigned get(const std::string &s)
+  {
+    string_ptrt string_ptr(s);
+
+    hash_tablet::iterator it = hash_table.find(string_ptr);
+    if(it != hash_table.end())
+      return it->second;
+
+    unsigned r = hash_table.size();
+
+    string_list.push_back(s);
+    std::string &obj = string_list.back();
+    hash_table.emplace(string_ptrt(obj), r);
+    string_vector.push_back(&obj);
+
+    return r;
+  }
+
+  const std::string &get_string(unsigned no) const
+  {
+    return *string_vector[no];
+  }
+
+protected:
+  typedef hash_map_cont<string_ptrt, unsigned, string_ptr_hash> hash_tablet;
+  hash_tablet hash_table;
+  std::list<std::string> string_list;
+  std::vector<std::string *> string_vector;
+};
+
+class sharded_string_containert : public string_containert
+{
+public:
+  unsigned get(const std::string &s)
+  {
+    return (*this)[s];
+  }
+};
+
+// Identifiers shaped like the ones symex produces
+static std::vector<std::string> make_names(unsigned n)
+{
+  std::vector<std::string> names;
+  names.reserve(n);
+  for(unsigned i = 0; i < n; i++)
+    names.push_back(
+      "c::main::" + std::to_string(i % 97) + "::var_" + std::to_string(i) +
+      "?1!0&0#" + std::to_string(i % 13));
+  return names;
+}
+
+static double seconds_since(std::chrono::steady_clock::time_point start)
+{
+  return std::chrono::duration<double>(
+           std::chrono::steady_clock::now() - start)
+    .count();
+}
+
+template <class containert>
+static void run_single(
+  const char *label,
+  const std::vector<std::string> &names,
+  unsigned rounds)
+{
+  containert *c = new containert();
+  std::vector<unsigned> ids(names.size());
+
+  auto start = std::chrono::steady_clock::now();
+  for(unsigned i = 0; i < names.size(); i++)
+    ids[i] = c->get(names[i]);
+  double t_insert = seconds_since(start);
+
+  start = std::chrono::steady_clock::now();
+  unsigned sum = 0;
+  for(unsigned r = 0; r < rounds; r++)
+    for(const auto &name : names)
+      sum += c->get(name);
+  double t_lookup = seconds_since(start);
+
+  start = std::chrono::steady_clock::now();
+  size_t len = 0;
+  for(unsigned r = 0; r < rounds; r++)
+    for(unsigned id : ids)
+      len += c->get_string(id).size();
+  double t_get = seconds_since(start);
+
+  printf(
+    "%-8s insert %.3fs  lookup %.3fs  get_string %.3fs  (%u %zu)\n",
+    label,
+    t_insert,
+    t_lookup,
+    t_get,
+    sum,
+    len);
+
+  delete c;
+}
+
+static void run_threads(const std::vector<std::string> &names, unsigned jobs)
+{
+  sharded_string_containert *c = new sharded_string_containert();
+
+  // Every thread interns every name, starting at a different offset, so
+  // that both first insertions and hits contend.
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> threads;
+  for(unsigned j = 0; j < jobs; j++)
+    threads.emplace_back([c, &names, j, jobs]() {
+      size_t n = names.size();
+      for(size_t i = 0; i < n; i++)
+      {
+        const std::string &s = names[(i + j * n / jobs) % n];
+        if(c->get_string(c->get(s)) != s)
+          abort();
+      }
+    });
+  for(auto &t : threads)
+    t.join();
+  double t = seconds_since(start);
+
+  printf(
+    "sharded  %u threads x %zu names: %.3fs (%.1f M ops/s)\n",
+    jobs,
+    names.size(),
+    t,
+    jobs * names.size() / t / 1e6);
+
+  delete c;
+}
+
+int main(int argc, const char **argv)
+{
+  unsigned n = argc > 1 ? atoi(argv[1]) : 1000000;
+  unsigned rounds = argc > 2 ? atoi(argv[2]) : 5;
+  std::vector<std::string> names = make_names(n);
+
+  run_single<single_string_containert>("single", names, rounds);
+  run_single<sharded_string_containert>("sharded", names, rounds);
+
+  unsigned max_jobs = std::thread::hardware_concurrency();
+  for(unsigned jobs = 1; jobs <= max_jobs && jobs <= 16; jobs *= 2)
+    run_threads(names, jobs);
+
+  return 0;
+}